@@ -2,30 +2,47 @@
 
 layout (location = 0) out vec4 color;
 
-layout (row_major, binding = 0) uniform data_buffer {
-    mat4 inv_view;
-    mat4 inv_proj;
-    vec3 origin;
-    float total_light_area;
-    uvec3 extent;
-    uint frame;
-    uvec2 tile_extent;
-} data;
-
 layout (rgba32f, binding = 0) uniform image2D accumulation;
 
+// per-pixel means of nodes visited, triangles tested, shadow rays and path length; only bound with debug counters
+layout (std430, binding = 16) readonly buffer debug_buffer {
+    vec4 debug_counters[];
+};
+
+const uint VIEW_COLOR = 0u;
+
+// which debug counter to show, and the count mapped to the top of the heatmap
+layout (location = 0) uniform uint view;
+layout (location = 1) uniform float scale;
+
+// polynomial fit of the turbo colormap
+vec3 heatmap(in float x) {
+    const vec4 r4 = vec4(0.13572138, 4.61539260, -42.66032258, 132.13108234);
+    const vec4 g4 = vec4(0.09140261, 2.19418839, 4.84296658, -14.18503333);
+    const vec4 b4 = vec4(0.10667330, 12.64194608, -60.58204836, 110.36276771);
+    const vec2 r2 = vec2(-152.94239396, 59.28637943);
+    const vec2 g2 = vec2(4.27729857, 2.82956604);
+    const vec2 b2 = vec2(-89.90310912, 27.34824973);
+
+    x = clamp(x, 0.0, 1.0);
+    vec4 v4 = vec4(1.0, x, x * x, x * x * x);
+    vec2 v2 = v4.zw * v4.z;
+    return vec3(dot(v4, r4) + dot(v2, r2), dot(v4, g4) + dot(v2, g2), dot(v4, b4) + dot(v2, b2));
+}
+
 void main() {
     ivec2 pixel = ivec2(gl_FragCoord.xy);
-    vec3 samples = imageLoad(accumulation, pixel).rgb;
 
-    uvec2 tile_count = (data.extent.xy + data.tile_extent - 1u) / data.tile_extent;
-    uint total_tile_count = tile_count.x * tile_count.y;
-    uint sample_index = data.frame / total_tile_count;
+    if (view != VIEW_COLOR) {
+        float value = debug_counters[pixel.y * imageSize(accumulation).x + pixel.x][view - 1u];
 
-    if (sample_index >= data.extent.z) {
-        color = vec4(sqrt(samples / (float(data.extent.z) + 1.0)), 1.0);
+        // logarithmic, so a few hot spots do not flatten everything else into the bottom color
+        color = vec4(heatmap(log2(1.0 + value) / log2(1.0 + scale)), 1.0);
         return;
     }
 
-    color = vec4(sqrt(samples / (float(sample_index) + 1.0)), 1.0);
+    vec4 samples = imageLoad(accumulation, pixel);
+
+    // alpha holds the per-pixel sample count, including reprojected history
+    color = vec4(sqrt(samples.rgb / max(samples.a, 1.0)), 1.0);
 }
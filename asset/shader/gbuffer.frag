@@ -0,0 +1,31 @@
+#version 450 core
+
+layout (row_major, binding = 0) uniform data_buffer {
+    mat4 inv_view;
+    mat4 inv_proj;
+    vec3 origin;
+    float total_light_area;
+    uvec3 extent;
+    uint frame;
+    uvec2 tile_extent;
+    uint sample_offset;
+    uint _0;
+    mat4 view_proj;
+    mat4 prev_view_proj;
+    vec2 jitter;
+} data;
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texture;
+layout (location = 3) flat in uint material;
+
+layout (location = 0) out vec4 gbuffer_position;
+layout (location = 1) out vec4 gbuffer_normal;
+layout (location = 2) out vec4 gbuffer_surface;
+
+void main() {
+    gbuffer_position = vec4(position, distance(position, data.origin));
+    gbuffer_normal = vec4(normalize(normal), 0.0);
+    gbuffer_surface = vec4(texture, float(material), 0.0);
+}
@@ -0,0 +1,53 @@
+#version 450 core
+
+struct vertex_t {
+    vec3 position;
+    float _0;
+    vec3 normal;
+    float _1;
+    vec2 texture;
+    uint material;
+    float _2;
+};
+
+layout (row_major, binding = 0) uniform data_buffer {
+    mat4 inv_view;
+    mat4 inv_proj;
+    vec3 origin;
+    float total_light_area;
+    uvec3 extent;
+    uint frame;
+    uvec2 tile_extent;
+    uint sample_offset;
+    uint _0;
+    mat4 view_proj;
+    mat4 prev_view_proj;
+    vec2 jitter;
+} data;
+
+layout (std430, binding = 1) buffer index_buffer {
+    uint indices[];
+};
+
+layout (std430, binding = 2) buffer vertex_buffer {
+    vertex_t vertices[];
+};
+
+layout (location = 0) out vec3 position;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec2 texture;
+layout (location = 3) flat out uint material;
+
+void main() {
+    vertex_t vertex = vertices[indices[gl_VertexID]];
+
+    position = vertex.position;
+    normal = vertex.normal;
+    texture = vertex.texture;
+    material = vertex.material;
+
+    gl_Position = data.view_proj * vec4(vertex.position, 1.0);
+
+    // shift the raster grid so pixel centers land on the jittered primary ray of this sample
+    gl_Position.xy -= 2.0 * data.jitter / vec2(data.extent.xy) * gl_Position.w;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glrt/context.hxx>
+#include <glrt/image.hxx>
+#include <glrt/options.hxx>
+
+struct image_error_t
+{
+    double rmse{};
+    double rel_mse{};
+};
+
+// per channel; relMSE divides by the squared reference plus a small epsilon so dark pixels do not dominate
+image_error_t image_error(const image_t &image, const image_t &reference);
+
+// renders without presenting and logs error against options.reference at sample and time checkpoints; without a
+// reference file the finished image becomes the reference
+int run_benchmark(const options_t &options, context_t &context);
+
+// runs the benchmark over the built-in scene list, one child process per scene, against <options.reference>/<name>.pfm.
+// missing references are rendered first at a high sample count with default settings
+int run_benchmark_suite(const options_t &options);
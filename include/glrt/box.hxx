@@ -10,3 +10,8 @@ struct box_t
 
 box_t box_empty();
 box_t box_union(const box_t &a, const box_t &b);
+box_t box_union(const box_t &a, const vec3f &p);
+box_t box_intersection(const box_t &a, const box_t &b);
+
+bool box_valid(const box_t &box);
+float box_area(const box_t &box);
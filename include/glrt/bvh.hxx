@@ -7,19 +7,39 @@
 
 constexpr std::uint32_t MAX_LEAF_TRIS = 8;
 
+// leaf count marking a compact child as an inner node
+constexpr std::uint32_t COMPACT_INNER = 0xf;
+
+static_assert(MAX_LEAF_TRIS < COMPACT_INNER, "leaf counts must fit below the compact inner marker");
+
 struct bvh_t
 {
     std::vector<bvh_node_t> nodes;
+    std::vector<compact_bvh_node_t> compact_nodes;
     std::vector<std::uint32_t> map;
     std::vector<std::uint32_t> lights;
     std::vector<float> light_areas;
     float total_light_area{};
 };
 
+struct bvh_options_t
+{
+    // extra triangle references spatial splits may create, as a fraction of the triangle count; 0 disables them
+    float split_budget{};
+};
+
 std::uint32_t build_bvh_node(
     std::vector<bvh_node_t> &nodes,
     std::vector<triangle_t> &triangles,
     std::uint32_t begin,
     std::uint32_t end);
 
-void build_bvh(const model_t &model, bvh_t &tree);
+void build_sbvh(const model_t &model, std::vector<triangle_t> &&triangles, float split_budget, bvh_t &tree);
+
+void build_bvh(const model_t &model, bvh_t &tree, const bvh_options_t &options = {});
+
+// encodes tree.nodes into tree.compact_nodes; sibling leaves must be adjacent in tree.map, as both builders leave them.
+// fails, leaving compact_nodes empty, when a node's children cannot be enclosed at any scale
+bool compact_bvh(bvh_t &tree);
+
+box_t dequantize_child(const compact_bvh_node_t &node, unsigned child);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glrt/math.hxx>
+
+struct camera_t
+{
+    vec3f position;
+    float yaw{};
+    float pitch{};
+};
+
+vec3f camera_forward(const camera_t &camera);
+vec3f camera_right(const camera_t &camera);
+
+mat4f camera_view(const camera_t &camera);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <glrt/bvh.hxx>
+#include <glrt/edit.hxx>
+#include <glrt/environment.hxx>
+#include <glrt/gl.hxx>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+#include <glrt/paging.hxx>
+#include <glrt/variant.hxx>
+
+constexpr vec2u DEFAULT_TILE_EXTENT{ 64u, 64u };
+
+// what default.frag shows; every view past color is one channel of the debug counters
+enum debug_view_t : std::uint32_t
+{
+    DEBUG_VIEW_COLOR,
+    DEBUG_VIEW_NODES,
+    DEBUG_VIEW_TRIANGLES,
+    DEBUG_VIEW_SHADOW_RAYS,
+    DEBUG_VIEW_PATH_LENGTH,
+    DEBUG_VIEW_COUNT,
+};
+
+struct uniform_data_t
+{
+    mat4f inv_view;
+    mat4f inv_proj;
+    vec3f origin;
+    float total_light_area{};
+    vec3u extent;
+    std::uint32_t frame{};
+    vec2u tile_extent;
+    std::uint32_t sample_offset{};
+    std::uint32_t _0{};
+    mat4f view_proj;
+    mat4f prev_view_proj;
+    vec2f jitter;
+    std::uint32_t page_words{};
+    std::uint32_t environment_width{};
+};
+
+struct context_t
+{
+    uniform_data_t data;
+    mat4f view;
+    mat4f proj;
+
+    gl::VertexArray vertex_array;
+    gl::Texture accumulation;
+    gl::Texture guide;
+    gl::Texture history;
+    gl::Texture history_guide;
+
+    gl::Framebuffer gbuffer;
+    gl::Texture gbuffer_position;
+    gl::Texture gbuffer_normal;
+    gl::Texture gbuffer_surface;
+    gl::Texture gbuffer_depth;
+    std::uint32_t gbuffer_sample = 0xffffffffu;
+    std::uint32_t index_count{};
+
+    gl::Texture sample_state;
+    page_cache_t pages;
+
+    gl::Buffer data_buffer;
+    gl::Buffer index_buffer;
+    gl::Buffer vertex_buffer;
+    gl::Buffer material_buffer;
+    gl::Buffer node_buffer;
+    gl::Buffer map_buffer;
+    gl::Buffer light_buffer;
+    gl::Buffer light_area_buffer;
+    gl::Buffer sobol_buffer;
+    gl::Buffer compact_node_buffer;
+    gl::Buffer page_table_buffer;
+    gl::Buffer page_node_buffer;
+    gl::Buffer page_vertex_buffer;
+    gl::Buffer page_request_buffer;
+    gl::Buffer environment_buffer;
+    gl::Buffer restir_buffer;
+    std::uint32_t restir_sample = 0xffffffffu;
+
+    // per pixel: mean nodes visited, triangles tested, shadow rays and path length of a sample
+    gl::Buffer debug_buffer;
+    debug_view_t debug_view = DEBUG_VIEW_COLOR;
+
+    gl::Program draw_program;
+    gl::Program compute_program;
+    gl::Program reproject_program;
+    gl::Program gbuffer_program;
+    gl::Program restir_initial_program;
+    gl::Program restir_spatial_program;
+    bool raster_primary{};
+    bool paged{};
+    bool restir{};
+    bool debug_counters{};
+    std::uint32_t max_bounces{};
+
+    // what the programs were specialized for; edits that bring in new lobes reload them
+    variant_t variant;
+};
+
+void upload_scene(context_t &context, const model_t &model, const bvh_t &bvh);
+void load_programs(context_t &context, const variant_t &variant, gl::Error &error);
+bool upload_pages(context_t &context, const std::filesystem::path &path, std::uint32_t page_count, std::uint32_t slot_count);
+void upload_environment(context_t &context, const environment_t &environment);
+
+// regrows the scene buffers to the editable scene's reserved capacity, once after upload_scene
+void reserve_edits(context_t &context, const editable_scene_t &scene);
+
+// sends the dirty ranges of an edited scene and restarts accumulation; reloads the programs if a material needs a lobe
+// they were specialized without
+void upload_edits(context_t &context, editable_scene_t &scene, gl::Error &error);
+
+void resize_accumulation(context_t &context, std::uint32_t width, std::uint32_t height);
+
+void set_camera(context_t &context, const mat4f &view, const vec3f &origin);
+void reproject_accumulation(context_t &context);
+
+std::uint32_t tile_count(const context_t &context);
+
+// one greyscale pfm per counter, <prefix>_nodes.pfm and so on
+bool write_debug_counters(const context_t &context, const std::filesystem::path &prefix);
+
+bool dispatch_frame(context_t &context);
+void draw_accumulation(const context_t &context);
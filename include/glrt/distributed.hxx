@@ -0,0 +1,8 @@
+#pragma once
+
+#include <glrt/context.hxx>
+#include <glrt/math.hxx>
+#include <glrt/options.hxx>
+
+int run_coordinator(const options_t &options, const vec2u &tile_extent);
+int run_worker(const options_t &options, context_t &context);
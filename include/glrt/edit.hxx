@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glrt/bvh.hxx>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+
+constexpr std::uint32_t EDIT_NONE = 0xffffffffu;
+
+// element ranges of one array changed since the last upload; coalesced into few sub-buffer updates
+struct dirty_ranges_t
+{
+    void mark(std::size_t begin, std::size_t end);
+    void mark(std::size_t index);
+
+    // sorted, merged ranges; neighbours closer than gap elements are uploaded as one
+    [[nodiscard]] std::vector<std::pair<std::size_t, std::size_t>> ranges(std::size_t gap = 64) const;
+
+    [[nodiscard]] bool empty() const;
+    void clear();
+
+private:
+    std::vector<std::pair<std::size_t, std::size_t>> m_Ranges;
+};
+
+struct edit_range_t
+{
+    std::uint32_t begin{};
+    std::uint32_t count{};
+};
+
+// one mesh placed in the scene. its triangles hang below a single subtree root, and the top of the tree is made of
+// nodes owned by no object, so an object comes and goes by linking or unlinking that root
+struct scene_object_t
+{
+    edit_range_t vertices;
+    edit_range_t indices;
+    edit_range_t map;
+    std::uint32_t root = EDIT_NONE;
+    bool alive{};
+};
+
+// model and bvh kept editable in place: freed ranges are reused, so gpu arrays never move and only dirty ranges are
+// uploaded. needs the full node layout; compact and paged trees are rebuilt from scratch instead
+struct editable_scene_t
+{
+    model_t model;
+    bvh_t bvh;
+
+    std::vector<scene_object_t> objects;
+
+    // per node: parent and owning object, EDIT_NONE for the root and for top-level nodes
+    std::vector<std::uint32_t> parents;
+    std::vector<std::uint32_t> owners;
+    bool empty{};
+
+    std::vector<std::uint32_t> free_nodes;
+    std::vector<edit_range_t> free_vertices;
+    std::vector<edit_range_t> free_indices;
+    std::vector<edit_range_t> free_map;
+    std::vector<std::uint32_t> free_objects;
+    std::vector<std::uint32_t> free_materials;
+
+    // light slots by first index of their triangle; removed lights keep a zero area in place
+    std::unordered_map<std::uint32_t, std::uint32_t> light_slots;
+    std::vector<std::uint32_t> free_lights;
+    double light_area_sum{};
+
+    dirty_ranges_t dirty_indices;
+    dirty_ranges_t dirty_vertices;
+    dirty_ranges_t dirty_materials;
+    dirty_ranges_t dirty_nodes;
+    dirty_ranges_t dirty_map;
+    dirty_ranges_t dirty_lights;
+};
+
+// adopts a built scene as object 0; every range starts clean, matching what upload_scene sent
+void make_editable(model_t &&model, bvh_t &&bvh, editable_scene_t &scene);
+
+// copies mesh into the scene under transform, merging its materials by name; returns the object id
+std::uint32_t insert_mesh(editable_scene_t &scene, const model_t &mesh, const mat4f &transform = identity<4, float>());
+void remove_mesh(editable_scene_t &scene, std::uint32_t object);
+void replace_mesh(
+    editable_scene_t &scene,
+    std::uint32_t object,
+    const model_t &mesh,
+    const mat4f &transform = identity<4, float>());
+
+std::uint32_t add_material(editable_scene_t &scene, const std::string &name, const material_t &material);
+void replace_material(editable_scene_t &scene, std::uint32_t material, const material_t &value);
+
+// false while a live object still references the material
+bool remove_material(editable_scene_t &scene, std::uint32_t material);
+
+// true if any array has ranges waiting for upload_edits
+[[nodiscard]] bool has_edits(const editable_scene_t &scene);
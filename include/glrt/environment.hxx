@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <glrt/image.hxx>
+#include <glrt/types.hxx>
+
+// equirectangular map, +y up; row 0 is the zenith
+struct environment_t
+{
+    std::uint32_t width{};
+    std::uint32_t height{};
+    std::vector<environment_texel_t> texels;
+};
+
+// .hdr or .pfm, flipped so rows run top to bottom
+bool read_environment(const std::filesystem::path &path, image_t &image);
+
+// alias table over luminance times sin(theta), so texels are picked in proportion to the power they subtend
+void build_environment(const image_t &image, environment_t &environment);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <glrt/context.hxx>
+#include <glrt/frame_ring.hxx>
+#include <glrt/gl.hxx>
+
+// pixel-pack buffers the accumulation is copied into; the render loop moves on while the copy runs
+constexpr std::size_t EXPORT_READBACKS = 2;
+
+struct readback_t
+{
+    gl::Buffer buffer;
+    gl::Fence fence;
+    const void *pixels{};
+    std::size_t capacity{};
+
+    std::uint32_t width{};
+    std::uint32_t height{};
+    std::uint32_t samples{};
+    bool pending{};
+};
+
+struct frame_export_t
+{
+    frame_ring_t ring;
+    std::array<readback_t, EXPORT_READBACKS> readbacks;
+    std::size_t next{};
+
+    // cpu time spent on the render thread, for the overhead report at close
+    double queue_seconds{};
+    double publish_seconds{};
+    std::uint64_t queued{};
+    std::uint64_t published{};
+    std::uint64_t dropped{};
+};
+
+// slots start out sized for width x height and grow with the window; until it succeeds the calls below do nothing
+bool open_export(
+    frame_export_t &frame_export,
+    const std::string &name,
+    frame_format_t format,
+    std::uint32_t width,
+    std::uint32_t height);
+
+// starts copying the frame into the next free readback: the tonemapped back buffer for ldr rings, so call it between
+// draw_accumulation and the swap, or the accumulation for raw ones. with both readbacks still in flight the frame is
+// dropped rather than waited for
+void queue_export(const context_t &context, frame_export_t &frame_export);
+
+// publishes every readback the gpu has finished, oldest first, without blocking; call once per loop iteration
+void publish_exports(frame_export_t &frame_export);
+
+// waits for the readbacks still in flight, publishes them, and logs the per-frame overhead
+void close_export(frame_export_t &frame_export);
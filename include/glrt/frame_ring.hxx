@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// frames published through posix shared memory: a header, then FRAME_RING_SLOTS pixel slots of slot_bytes each.
+// one writer, any number of readers; a reader that falls behind skips frames instead of holding the writer up
+constexpr std::uint32_t FRAME_RING_MAGIC = 0x74726c67u; // "glrt"
+constexpr std::uint32_t FRAME_RING_VERSION = 1;
+constexpr std::uint32_t FRAME_RING_SLOTS = 4;
+
+enum frame_format_t : std::uint32_t
+{
+    // tonemapped as on screen, alpha 255
+    FRAME_RGBA8,
+    // accumulated radiance with the per-pixel sample count in alpha
+    FRAME_RGBA32F,
+};
+
+enum frame_ring_state_t : std::uint32_t
+{
+    FRAME_RING_OPEN,
+    // the writer moved to a larger segment under the same name; reopen it
+    FRAME_RING_STALE,
+    FRAME_RING_CLOSED,
+};
+
+// sequence is odd while the writer fills the slot; a reader copy is good if it saw the same even value before and
+// after. rows run top to bottom, tightly packed
+struct frame_slot_t
+{
+    std::atomic<std::uint64_t> sequence;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t samples;
+    std::uint32_t _0;
+    std::uint64_t time_ns;
+};
+
+struct frame_ring_header_t
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    frame_format_t format;
+    std::uint32_t slot_count;
+    std::uint64_t slot_bytes;
+    std::uint64_t data_offset;
+
+    // frames published so far; the latest lives in slot (frames - 1) % slot_count
+    std::atomic<std::uint64_t> frames;
+    std::atomic<frame_ring_state_t> state;
+    std::uint32_t _0;
+
+    frame_slot_t slots[FRAME_RING_SLOTS];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<frame_ring_state_t>::is_always_lock_free);
+
+struct frame_ring_t
+{
+    std::string name;
+    void *memory{};
+    std::size_t size{};
+    bool owner{};
+};
+
+struct frame_info_t
+{
+    std::uint64_t frame{};
+    std::uint32_t width{};
+    std::uint32_t height{};
+    std::uint32_t samples{};
+    std::uint64_t time_ns{};
+};
+
+[[nodiscard]] std::size_t frame_pixel_bytes(frame_format_t format);
+
+// name follows shm_open, e.g. "/glrt"; a leftover segment of the same name is replaced
+bool create_frame_ring(const std::string &name, frame_format_t format, std::size_t slot_bytes, frame_ring_t &ring);
+bool open_frame_ring(const std::string &name, frame_ring_t &ring);
+
+// moves the writer to a new segment with larger slots under the same name; readers of the old one see it go stale
+bool resize_frame_ring(frame_ring_t &ring, std::size_t slot_bytes);
+
+// the writer marks the ring closed and unlinks the name; mappings stay valid until every side has closed
+void close_frame_ring(frame_ring_t &ring);
+
+[[nodiscard]] frame_ring_header_t &ring_header(const frame_ring_t &ring);
+
+// writer side: the returned slot takes width * height pixels and stays hidden from readers until publish_frame
+std::byte *begin_frame(const frame_ring_t &ring, std::uint32_t width, std::uint32_t height, std::uint32_t samples);
+void publish_frame(const frame_ring_t &ring);
+
+// reader side: copies the latest frame if it is newer than info.frame. false if there is none or the writer
+// overwrote it during the copy
+bool read_frame(const frame_ring_t &ring, frame_info_t &info, std::vector<std::byte> &pixels);
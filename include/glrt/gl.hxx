@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <initializer_list>
 #include <string>
+#include <vector>
 #include <GL/glew.h>
 
 namespace gl
@@ -37,7 +39,17 @@ namespace gl
         Buffer &operator=(Buffer &&) noexcept;
 
         void Data(const void *buffer, std::size_t length, GLenum usage) const;
+        void Storage(const void *buffer, std::size_t length, GLbitfield flags) const;
+        void SubData(std::size_t offset, const void *buffer, std::size_t length) const;
+        void GetSubData(std::size_t offset, void *buffer, std::size_t length) const;
+        void Clear(GLenum internal_format, GLenum format, GLenum type, const void *data) const;
         void Bind(GLenum target, GLuint index) const;
+        void Bind(GLenum target) const;
+
+        [[nodiscard]] void *MapRange(std::size_t offset, std::size_t length, GLbitfield access) const;
+        void Unmap() const;
+
+        [[nodiscard]] std::size_t Size() const;
 
     private:
         GLuint m_Handle{};
@@ -63,6 +75,8 @@ namespace gl
 
     class Texture
     {
+        friend class Framebuffer;
+
     public:
         explicit Texture(GLenum target);
         ~Texture();
@@ -78,6 +92,101 @@ namespace gl
 
         void BindImage(GLuint unit, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format) const;
 
+        void GetSubImage(
+            GLint level,
+            GLint x,
+            GLint y,
+            GLsizei width,
+            GLsizei height,
+            GLenum format,
+            GLenum type,
+            GLsizei size,
+            void *pixels) const;
+        void ClearSubImage(
+            GLint level,
+            GLint x,
+            GLint y,
+            GLsizei width,
+            GLsizei height,
+            GLenum format,
+            GLenum type,
+            const void *data) const;
+
+    private:
+        GLuint m_Handle{};
+    };
+
+    struct SpecializationConstant
+    {
+        GLuint index;
+        GLuint value;
+    };
+
+    class Framebuffer
+    {
+    public:
+        Framebuffer();
+        ~Framebuffer();
+
+        Framebuffer(const Framebuffer &) = delete;
+        Framebuffer &operator=(const Framebuffer &) = delete;
+
+        Framebuffer(Framebuffer &&) noexcept;
+        Framebuffer &operator=(Framebuffer &&) noexcept;
+
+        void Bind(GLenum target) const;
+
+        void Attach(GLenum attachment, const Texture &texture, GLint level) const;
+        void DrawBuffers(std::initializer_list<GLenum> buffers) const;
+
+        void ClearColor(GLint buffer, const GLfloat *value) const;
+        void ClearDepth(GLfloat value) const;
+
+        void CheckStatus(GLenum target, Error &error) const;
+
+    private:
+        GLuint m_Handle{};
+    };
+
+    class Fence
+    {
+    public:
+        Fence();
+        ~Fence();
+
+        Fence(const Fence &) = delete;
+        Fence &operator=(const Fence &) = delete;
+
+        Fence(Fence &&) noexcept;
+        Fence &operator=(Fence &&) noexcept;
+
+        void Insert();
+
+        // false only while the commands before the fence are still running after timeout nanoseconds
+        [[nodiscard]] bool Wait(GLuint64 timeout) const;
+
+    private:
+        GLsync m_Handle{};
+    };
+
+    class Query
+    {
+    public:
+        explicit Query(GLenum target);
+        ~Query();
+
+        Query(const Query &) = delete;
+        Query &operator=(const Query &) = delete;
+
+        Query(Query &&) noexcept;
+        Query &operator=(Query &&) noexcept;
+
+        // records the gpu time once every command issued before it has completed
+        void Counter() const;
+
+        // blocks until the result is available
+        [[nodiscard]] GLuint64 Result() const;
+
     private:
         GLuint m_Handle{};
     };
@@ -98,6 +207,12 @@ namespace gl
 
         void Source(const GLchar *source, GLint length) const;
         void Binary(GLenum format, const void *binary, GLsizei length, Error &error) const;
+        void Binary(
+            GLenum format,
+            const void *binary,
+            GLsizei length,
+            const std::vector<SpecializationConstant> &constants,
+            Error &error) const;
 
         void Compile(Error &error) const;
 
@@ -125,6 +240,12 @@ namespace gl
         void Validate(Error &error) const;
 
         void Binary(GLenum format, const void *binary, GLsizei length, Error &error) const;
+        void GetBinary(GLenum &format, std::vector<char> &binary) const;
+
+        void Parameter(GLenum name, GLint value) const;
+
+        void Uniform(GLint location, GLuint value) const;
+        void Uniform(GLint location, GLfloat value) const;
 
         void LoadShaderSource(const std::filesystem::path &path, GLenum type, Error &error) const;
         void LoadShaderBinary(const std::filesystem::path &path, GLenum type, GLenum format, Error &error) const;
@@ -132,4 +253,22 @@ namespace gl
     private:
         GLuint m_Handle{};
     };
+
+    struct ShaderStage
+    {
+        std::filesystem::path path;
+        GLenum type;
+        std::vector<SpecializationConstant> constants{};
+    };
+
+    class ProgramCache
+    {
+    public:
+        explicit ProgramCache(std::filesystem::path directory);
+
+        void Load(const Program &program, std::initializer_list<ShaderStage> stages, Error &error) const;
+
+    private:
+        std::filesystem::path m_Directory;
+    };
 }
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <filesystem>
+
+struct model_t;
+
+// maps a binary glTF and flattens its default scene into model; node transforms are baked into the vertices
+bool read_glb(const std::filesystem::path &path, model_t &model);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct image_t
+{
+    std::uint32_t width{};
+    std::uint32_t height{};
+    std::vector<float> pixels;
+
+    // 3, or 1 for greyscale; read_pfm only takes color
+    std::uint32_t channels = 3;
+};
+
+// rows are stored bottom to top, as in the file; greyscale images are written as Pf
+bool read_pfm(const std::filesystem::path &path, image_t &image);
+bool write_pfm(const std::filesystem::path &path, const image_t &image);
+
+// radiance RGBE, flat or run-length encoded scanlines; rows are stored top to bottom
+bool read_hdr(const std::filesystem::path &path, image_t &image);
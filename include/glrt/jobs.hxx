@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// jobs spawned into a group are joined by waiting on it; the waiting thread runs queued jobs meanwhile
+struct job_group_t
+{
+    std::atomic<std::size_t> pending{};
+};
+
+// fixed worker threads with one deque each: owners push and pop at the back, idle threads steal from the front.
+// the thread that constructed the system takes part through wait; with one thread every job runs inline
+class job_system_t
+{
+public:
+    explicit job_system_t(unsigned thread_count);
+    ~job_system_t();
+
+    job_system_t(const job_system_t &) = delete;
+    job_system_t &operator=(const job_system_t &) = delete;
+
+    [[nodiscard]] unsigned thread_count() const;
+
+    void spawn(job_group_t &group, std::function<void()> job);
+    void wait(job_group_t &group);
+
+    // splits [begin, end) in halves down to grain elements; body sees disjoint ranges, so writes by index keep
+    // the output identical to a serial loop
+    void parallel_for(
+        std::size_t begin,
+        std::size_t end,
+        std::size_t grain,
+        const std::function<void(std::size_t, std::size_t)> &body);
+
+private:
+    struct job_t
+    {
+        std::function<void()> function;
+        job_group_t *group;
+    };
+
+    struct queue_t
+    {
+        std::mutex mutex;
+        std::deque<job_t> jobs;
+    };
+
+    void worker(unsigned index);
+    bool run_one(unsigned index);
+    unsigned current_queue() const;
+
+    void split_range(
+        job_group_t &group,
+        std::size_t begin,
+        std::size_t end,
+        std::size_t grain,
+        const std::function<void(std::size_t, std::size_t)> &body);
+
+    std::vector<std::unique_ptr<queue_t>> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_SleepMutex;
+    std::condition_variable m_Wake;
+    std::atomic<std::size_t> m_Queued{};
+    std::atomic<bool> m_Running{ true };
+};
+
+// process-wide system; the first call fixes the thread count, 0 meaning one per hardware thread
+job_system_t &jobs(unsigned thread_count = 0);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <glrt/box.hxx>
+#include <glrt/math.hxx>
+#include <glrt/triangle.hxx>
+#include <glrt/types.hxx>
+
+void transform_vertices(const mat4f &transform, vertex_t *vertices, std::size_t count);
+
+box_t vertex_bounds(const vertex_t *vertices, std::size_t count);
+
+void triangle_bounds(const triangle_t *triangles, std::size_t count, box_t &bounds, box_t &centroid_bounds);
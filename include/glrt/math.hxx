@@ -27,6 +27,8 @@ struct vec
         return e[i];
     }
 
+    constexpr bool operator==(const vec &) const = default;
+
     template<unsigned... I>
     auto swizzle()
     {
@@ -99,6 +101,8 @@ struct mat
         return e[i];
     }
 
+    constexpr bool operator==(const mat &) const = default;
+
     explicit constexpr operator mat<N - 1, M - 1, T>() const
     {
         mat<N - 1, M - 1, T> m;
@@ -539,3 +543,5 @@ constexpr mat4f lookAt(const vec3f &eye, const vec3f &center, const vec3f &up)
 
     return m;
 }
+
+#include <glrt/simd.hxx>
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <map>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <glrt/types.hxx>
@@ -12,6 +13,8 @@ struct model_t
 
     model_t &operator+=(const model_t &other);
 
+    void merge_materials(const model_t &other, std::pmr::vector<std::uint32_t> &remap);
+
     std::map<std::string, std::uint32_t> material_map;
 
     std::vector<std::uint32_t> indices;
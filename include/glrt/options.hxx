@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+enum run_mode_t
+{
+    MODE_INTERACTIVE,
+    MODE_WORKER,
+    MODE_COORDINATOR,
+    MODE_BENCHMARK,
+    MODE_BENCHMARK_SUITE,
+};
+
+struct options_t
+{
+    run_mode_t mode = MODE_INTERACTIVE;
+
+    std::uint32_t width = 600;
+    std::uint32_t height = 600;
+    std::uint32_t samples = 1600;
+    std::uint32_t split_budget = 0;
+    bool compact_nodes = false;
+    bool raster_primary = false;
+    std::uint32_t page_budget = 0;
+    std::filesystem::path page_file;
+    bool restir = false;
+    std::uint32_t present_hz = 60;
+    std::uint32_t threads = 0;
+    std::filesystem::path scene;
+    std::filesystem::path environment;
+    std::filesystem::path trace;
+    std::string export_name;
+    bool export_raw = false;
+    std::filesystem::path debug_counters;
+
+    std::string address;
+    std::uint32_t workers = 0;
+    std::uint32_t local_workers = 0;
+    std::uint32_t unit_samples = 16;
+    std::filesystem::path output = "output.pfm";
+    std::filesystem::path reference;
+    std::filesystem::path curve = "convergence.csv";
+};
+
+bool parse_options(int argc, const char *const *argv, options_t &options);
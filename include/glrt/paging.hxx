@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <glrt/bvh.hxx>
+#include <glrt/model.hxx>
+#include <glrt/types.hxx>
+
+constexpr std::uint32_t PAGE_TRIANGLES = 256;
+constexpr std::uint32_t PAGE_NODES = 2 * PAGE_TRIANGLES;
+constexpr std::uint32_t PAGE_NONE = 0xffffffffu;
+
+// paths that missed a page are retried this many times per frame before the frame moves on
+constexpr std::uint32_t PAGE_RETRIES = 8;
+
+struct page_header_t
+{
+    std::uint32_t node_count{};
+    std::uint32_t triangle_count{};
+    std::uint32_t _0{};
+    std::uint32_t _1{};
+};
+
+// one treelet and its de-indexed triangles, written to disk at a fixed stride
+struct page_t
+{
+    page_header_t header;
+    bvh_node_t nodes[PAGE_NODES];
+    vertex_t vertices[PAGE_TRIANGLES * 3];
+};
+
+constexpr std::uint64_t PAGE_FILE_MAGIC = 0x31454c4946454741ull;
+
+// last bytes of a page file; the resident top level, lights and materials sit between the pages and this, so a later
+// run can render from the file without loading the scene. written last, so a file cut short is never taken as whole
+struct page_file_trailer_t
+{
+    std::uint64_t magic{};
+    std::uint64_t key{};
+    std::uint64_t resident_offset{};
+    std::uint32_t page_count{};
+    std::uint32_t page_bytes{};
+};
+
+struct page_cache_t
+{
+    std::ifstream file;
+
+    std::uint32_t page_count{};
+    std::uint32_t slot_count{};
+
+    std::vector<std::uint32_t> page_slots;
+    std::vector<std::uint32_t> slot_pages;
+    std::vector<std::uint64_t> slot_clock;
+    std::uint64_t clock{};
+
+    std::uint32_t retries{};
+
+    // set once a dispatch gave up on paths that kept missing
+    bool dropped{};
+};
+
+// cuts the tree into treelets of at most PAGE_TRIANGLES and writes them to path; tree.nodes keeps the resident
+// top level, whose leaves hold page ids, and the model shrinks to the emissive triangles light sampling needs. key
+// identifies the source scene for read_paged_scene
+bool page_bvh(
+    model_t &model,
+    bvh_t &tree,
+    const std::filesystem::path &path,
+    std::uint64_t key,
+    std::uint32_t &page_count);
+
+// the resident part page_bvh left in model and tree, read back from a whole page file written with the same key;
+// the full scene is never loaded
+bool read_paged_scene(
+    const std::filesystem::path &path,
+    std::uint64_t key,
+    model_t &model,
+    bvh_t &tree,
+    std::uint32_t &page_count);
+
+bool open_page_cache(page_cache_t &cache, const std::filesystem::path &path, std::uint32_t page_count, std::uint32_t slot_count);
+
+bool read_page(page_cache_t &cache, std::uint32_t page, page_t &data);
+
+// least recently used slot; slots touched at the current clock go last
+std::uint32_t evict_slot(const page_cache_t &cache);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+
+struct scene_builder_t
+{
+    // keeps a pointer, not a copy: model must stay alive and unchanged until build() returns
+    void add(const model_t &model, const mat4f &transform = identity<4, float>());
+
+    // takes the model over; nothing needs to outlive the call
+    void add(model_t &&model, const mat4f &transform = identity<4, float>());
+
+    void build(model_t &model);
+
+private:
+    struct part_t
+    {
+        const model_t *model;
+        mat4f transform;
+        model_t *owned;
+    };
+
+    std::vector<part_t> m_Parts;
+    std::deque<model_t> m_Storage;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <type_traits>
+#include <glrt/math.hxx>
+
+#if !defined(GLRT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define GLRT_SIMD 1
+#endif
+
+#ifdef GLRT_SIMD
+
+#include <immintrin.h>
+
+namespace simd
+{
+    inline __m128 load(const vec4f &v)
+    {
+        return _mm_loadu_ps(v.e);
+    }
+
+    inline __m128 load(const vec3f &v)
+    {
+        const auto xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(v.e)));
+        const auto z = _mm_load_ss(v.e + 2);
+        return _mm_movelh_ps(xy, z);
+    }
+
+    inline vec4f store4(const __m128 x)
+    {
+        vec4f v;
+        _mm_storeu_ps(v.e, x);
+        return v;
+    }
+
+    inline vec3f store3(const __m128 x)
+    {
+        vec3f v;
+        _mm_storel_pi(reinterpret_cast<__m64 *>(v.e), x);
+        _mm_store_ss(v.e + 2, _mm_movehl_ps(x, x));
+        return v;
+    }
+
+    inline float hsum(const __m128 x)
+    {
+        const auto a = _mm_add_ps(x, _mm_movehl_ps(x, x));
+        const auto b = _mm_add_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(b);
+    }
+
+    inline __m128 transform(const mat4f &m, const __m128 v)
+    {
+        auto r0 = _mm_mul_ps(load(m[0]), v);
+        auto r1 = _mm_mul_ps(load(m[1]), v);
+        auto r2 = _mm_mul_ps(load(m[2]), v);
+        auto r3 = _mm_mul_ps(load(m[3]), v);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        return _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+    }
+}
+
+#define GLRT_SIMD_VEC_BINARY(N, OP, INTRINSIC)                                      \
+    constexpr vec<N, float> operator OP(const vec<N, float> &lhs, const vec<N, float> &rhs) \
+    {                                                                               \
+        if (std::is_constant_evaluated())                                           \
+            return operator OP<N, float>(lhs, rhs);                                 \
+        return simd::store##N(INTRINSIC(simd::load(lhs), simd::load(rhs)));         \
+    }                                                                               \
+    constexpr vec<N, float> operator OP(const vec<N, float> &lhs, const float &rhs) \
+    {                                                                               \
+        if (std::is_constant_evaluated())                                           \
+            return operator OP<N, float>(lhs, rhs);                                 \
+        return simd::store##N(INTRINSIC(simd::load(lhs), _mm_set1_ps(rhs)));        \
+    }                                                                               \
+    constexpr vec<N, float> operator OP(const float &lhs, const vec<N, float> &rhs) \
+    {                                                                               \
+        if (std::is_constant_evaluated())                                           \
+            return operator OP<N, float>(lhs, rhs);                                 \
+        return simd::store##N(INTRINSIC(_mm_set1_ps(lhs), simd::load(rhs)));        \
+    }
+
+#define GLRT_SIMD_VEC_FUNCTION(N, NAME, INTRINSIC)                                  \
+    constexpr vec<N, float> NAME(const vec<N, float> &lhs, const vec<N, float> &rhs) \
+    {                                                                               \
+        if (std::is_constant_evaluated())                                           \
+            return NAME<N, float>(lhs, rhs);                                        \
+        return simd::store##N(INTRINSIC(simd::load(lhs), simd::load(rhs)));         \
+    }
+
+#define GLRT_SIMD_VEC(N)                                                            \
+    GLRT_SIMD_VEC_BINARY(N, +, _mm_add_ps)                                          \
+    GLRT_SIMD_VEC_BINARY(N, -, _mm_sub_ps)                                          \
+    GLRT_SIMD_VEC_BINARY(N, *, _mm_mul_ps)                                          \
+    GLRT_SIMD_VEC_BINARY(N, /, _mm_div_ps)                                          \
+    GLRT_SIMD_VEC_FUNCTION(N, min, _mm_min_ps)                                      \
+    GLRT_SIMD_VEC_FUNCTION(N, max, _mm_max_ps)                                      \
+    constexpr float dot(const vec<N, float> &lhs, const vec<N, float> &rhs)         \
+    {                                                                               \
+        if (std::is_constant_evaluated())                                           \
+            return dot<N, float>(lhs, rhs);                                         \
+        return simd::hsum(_mm_mul_ps(simd::load(lhs), simd::load(rhs)));            \
+    }                                                                               \
+    constexpr float length_squared(const vec<N, float> &v)                          \
+    {                                                                               \
+        return dot(v, v);                                                           \
+    }
+
+GLRT_SIMD_VEC(3)
+GLRT_SIMD_VEC(4)
+
+#undef GLRT_SIMD_VEC
+#undef GLRT_SIMD_VEC_FUNCTION
+#undef GLRT_SIMD_VEC_BINARY
+
+constexpr vec4f operator*(const mat4f &lhs, const vec4f &rhs)
+{
+    if (std::is_constant_evaluated())
+        return operator*<4, float>(lhs, rhs);
+    return simd::store4(simd::transform(lhs, simd::load(rhs)));
+}
+
+constexpr vec3f operator*(const mat4f &lhs, const vec3f &rhs)
+{
+    if (std::is_constant_evaluated())
+        return operator*<4, float>(lhs, rhs);
+
+    const auto p = _mm_or_ps(simd::load(rhs), _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+    const auto r = simd::transform(lhs, p);
+    return simd::store3(_mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+
+constexpr mat4f operator*(const mat4f &lhs, const mat4f &rhs)
+{
+    if (std::is_constant_evaluated())
+        return operator*<4, float>(lhs, rhs);
+
+    const auto b0 = simd::load(rhs[0]);
+    const auto b1 = simd::load(rhs[1]);
+    const auto b2 = simd::load(rhs[2]);
+    const auto b3 = simd::load(rhs[3]);
+
+    mat4f m;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const auto a = simd::load(lhs[i]);
+        auto r = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+        m[i] = simd::store4(r);
+    }
+    return m;
+}
+
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+constexpr std::uint32_t SOBOL_DIMENSIONS = 4;
+constexpr std::uint32_t SOBOL_BITS = 32;
+
+void build_sobol_directions(std::vector<std::uint32_t> &directions);
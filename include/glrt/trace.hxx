@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// zones are recorded once trace_begin has run and written as chrome trace-event json (chrome://tracing, perfetto)
+// by trace_end. every thread appends to a buffer only it writes, so recording takes no lock; while tracing is off
+// a zone costs one relaxed load
+void trace_begin(const std::filesystem::path &path);
+bool trace_end();
+
+[[nodiscard]] bool trace_enabled();
+
+// names the calling thread's row in the trace; takes effect only before its first zone
+void trace_thread_name(std::string name);
+
+// times a scope on the calling thread. name must outlive the trace, which string literals do
+class trace_zone_t
+{
+public:
+    explicit trace_zone_t(const char *name);
+    ~trace_zone_t();
+
+    trace_zone_t(const trace_zone_t &) = delete;
+    trace_zone_t &operator=(const trace_zone_t &) = delete;
+
+private:
+    const char *m_Name{};
+    std::uint64_t m_Begin{};
+};
+
+// times the gl commands issued in a scope with timestamp queries, mapped onto the cpu clock. only valid on the thread
+// owning the gl context
+class gpu_zone_t
+{
+public:
+    explicit gpu_zone_t(const char *name);
+    ~gpu_zone_t();
+
+    gpu_zone_t(const gpu_zone_t &) = delete;
+    gpu_zone_t &operator=(const gpu_zone_t &) = delete;
+
+private:
+    static constexpr std::size_t NONE = ~std::size_t{};
+
+    std::size_t m_Index = NONE;
+};
@@ -21,6 +21,8 @@ struct alignas(16) material_t
 {
     [[nodiscard]] bool is_emissive() const;
 
+    bool operator==(const material_t &) const = default;
+
     vec3f albedo;
     float _0{};
 
@@ -47,3 +49,69 @@ struct alignas(16) bvh_node_t
     std::uint32_t begin{};
     std::uint32_t end{};
 };
+
+// two quantized child boxes in the frame of their parent; see compact_bvh
+struct alignas(16) compact_bvh_node_t
+{
+    vec3f origin;
+
+    // biased exponents of the per-axis scale in bytes 0..2, child leaf counts in the top two nibbles
+    std::uint32_t meta{};
+
+    // per axis: left min, left max, right min, right max, one byte each
+    std::uint32_t bounds[3]{};
+
+    // first inner child is the next node; the link is the other inner child or the first leaf begin
+    std::uint32_t link{};
+};
+
+// keep the entry's own index with probability threshold, otherwise take alias
+struct alias_entry_t
+{
+    float threshold{};
+    std::uint32_t alias{};
+};
+
+// radiance of one environment texel, the probability of sampling it and its alias table entry
+struct alignas(16) environment_texel_t
+{
+    vec3f radiance;
+    float pdf{};
+
+    alias_entry_t alias;
+};
+
+// weighted reservoir over light points; weight is the unbiased contribution weight of the kept sample
+struct alignas(16) reservoir_t
+{
+    vec3f position;
+    float weight_sum{};
+
+    vec3f normal;
+    float count{};
+
+    vec3f emission;
+    float weight{};
+};
+
+// primary hit a reservoir was resampled for; depth < 0 marks pixels without direct light to resample
+struct alignas(16) restir_surface_t
+{
+    vec3f position;
+    std::uint32_t material{};
+
+    vec3f normal;
+    float depth{};
+
+    vec3f view;
+    float _0{};
+};
+
+// everything restir keeps per pixel, in one storage block alongside the others
+struct alignas(16) restir_pixel_t
+{
+    reservoir_t reservoir;
+    reservoir_t history;
+    restir_surface_t surface;
+};
+
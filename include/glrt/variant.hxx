@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <glrt/model.hxx>
+
+constexpr std::uint32_t DEFAULT_MAX_BOUNCES = 5;
+
+enum lobe_bits : std::uint32_t
+{
+    LOBE_DIFFUSE = 1u << 0,
+    LOBE_SHEEN = 1u << 1,
+    LOBE_CLEARCOAT = 1u << 2,
+};
+
+enum specialization_id : std::uint32_t
+{
+    SPEC_LOBES = 0,
+    SPEC_MAX_BOUNCES = 1,
+    SPEC_LEAF_SIZE = 2,
+    SPEC_PASS = 3,
+    SPEC_COMPACT_NODES = 4,
+    SPEC_RASTER_PRIMARY = 5,
+    SPEC_PAGED = 6,
+    SPEC_ENVIRONMENT = 7,
+    SPEC_RESTIR = 8,
+    SPEC_DEBUG_COUNTERS = 9,
+};
+
+enum pass_id : std::uint32_t
+{
+    PASS_TRACE = 0,
+    PASS_REPROJECT = 1,
+    PASS_RESTIR_INITIAL = 2,
+    PASS_RESTIR_SPATIAL = 3,
+};
+
+struct variant_t
+{
+    std::uint32_t lobes{};
+    std::uint32_t max_bounces{};
+    std::uint32_t leaf_size{};
+    std::uint32_t compact_nodes{};
+    std::uint32_t raster_primary{};
+    std::uint32_t paged{};
+    std::uint32_t environment{};
+    std::uint32_t restir{};
+    std::uint32_t debug_counters{};
+};
+
+variant_t select_variant(const model_t &model);
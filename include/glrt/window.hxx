@@ -7,6 +7,7 @@ class Window
 {
 public:
     Window();
+    Window(int width, int height);
     ~Window();
 
     Window(const Window &) = delete;
@@ -23,6 +24,10 @@ public:
 
     void SetFramebufferSizeCallback(void (*callback)(GLFWwindow *window, int width, int height)) const;
 
+    [[nodiscard]] bool GetKey(int key) const;
+    [[nodiscard]] bool GetMouseButton(int button) const;
+    void GetCursorPos(double &x, double &y) const;
+
     void Show() const;
 
     [[nodiscard]] bool ShouldClose() const;
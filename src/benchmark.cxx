@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glrt/benchmark.hxx>
+
+static constexpr double CHECKPOINT_SECONDS = 1.0;
+static constexpr double REL_MSE_EPSILON = 1e-2;
+
+struct benchmark_scene_t
+{
+    const char *name;
+    const char *scene;
+};
+
+// fixed so curves from different builds and machines compare; an empty scene is the generated cornell box
+static constexpr benchmark_scene_t BENCHMARK_SCENES[]
+{
+    { "generated", "" },
+    { "cornell", "asset/model/cornell/cornell.obj" },
+    { "teapot", "asset/model/teapot/teapot.obj" },
+};
+
+static constexpr const char *BENCHMARK_SIZE = "512x512";
+static constexpr std::uint32_t REFERENCE_SAMPLES = 1u << 16;
+
+image_error_t image_error(const image_t &image, const image_t &reference)
+{
+    image_error_t error;
+
+    const auto count = image.pixels.size();
+    if (!count || count != reference.pixels.size())
+        return { NAN, NAN };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const double r = reference.pixels[i];
+        const double d = static_cast<double>(image.pixels[i]) - r;
+        error.rmse += d * d;
+        error.rel_mse += d * d / (r * r + REL_MSE_EPSILON);
+    }
+
+    error.rmse = std::sqrt(error.rmse / static_cast<double>(count));
+    error.rel_mse /= static_cast<double>(count);
+    return error;
+}
+
+// current estimate: accumulated radiance over the per-pixel sample count kept in alpha
+static void read_estimate(const context_t &context, std::vector<float> &rgba, image_t &image)
+{
+    const auto width = context.data.extent[0];
+    const auto height = context.data.extent[1];
+    const auto pixels = static_cast<std::size_t>(width) * height;
+
+    rgba.resize(pixels * 4);
+
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    context.accumulation.GetSubImage(
+        0,
+        0,
+        0,
+        static_cast<GLsizei>(width),
+        static_cast<GLsizei>(height),
+        GL_RGBA,
+        GL_FLOAT,
+        static_cast<GLsizei>(rgba.size() * sizeof(float)),
+        rgba.data());
+
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixels * 3);
+
+    for (std::size_t i = 0; i < pixels; ++i)
+        for (std::size_t c = 0; c < 3; ++c)
+            image.pixels[i * 3 + c] = rgba[i * 4 + c] / std::max(rgba[i * 4 + 3], 1.0f);
+}
+
+int run_benchmark(const options_t &options, context_t &context)
+{
+    resize_accumulation(context, options.width, options.height);
+
+    image_t reference;
+    const auto has_reference = read_pfm(options.reference, reference);
+
+    if (has_reference && (reference.width != options.width || reference.height != options.height))
+    {
+        std::cerr << options.reference << " is " << reference.width << "x" << reference.height
+                << ", the benchmark renders " << options.width << "x" << options.height << std::endl;
+        return 1;
+    }
+
+    std::ofstream curve;
+    if (has_reference)
+    {
+        curve.open(options.curve, std::ofstream::trunc);
+        if (!curve)
+        {
+            std::cerr << "failed to write " << options.curve << std::endl;
+            return 1;
+        }
+        curve << "samples,seconds,rmse,relmse\n" << std::setprecision(8);
+    }
+
+    const auto tiles = tile_count(context);
+
+    std::vector<float> rgba;
+    image_t image;
+
+    // the clock only runs while rendering; readback and error evaluation are excluded
+    double seconds = 0.0;
+    auto next_time = CHECKPOINT_SECONDS;
+    std::uint32_t next_samples = 1;
+
+    auto checkpoint = [&](const std::uint32_t samples)
+    {
+        read_estimate(context, rgba, image);
+        const auto error = image_error(image, reference);
+
+        curve << samples << ',' << seconds << ',' << error.rmse << ',' << error.rel_mse << '\n';
+        std::cerr << std::fixed << std::setprecision(3)
+                << samples << " spp, " << seconds << " s, rmse " << error.rmse << ", relmse " << error.rel_mse
+                << std::endl;
+    };
+
+    for (std::uint32_t sample = 0; sample < options.samples; ++sample)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (std::uint32_t tile = 0; tile < tiles; ++tile)
+            dispatch_frame(context);
+        glFinish();
+
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        const auto samples = sample + 1;
+        if (!has_reference)
+            continue;
+
+        // powers of two give the error-per-sample curve, the fixed interval the error-per-second one
+        if (samples == next_samples || seconds >= next_time || samples == options.samples)
+        {
+            checkpoint(samples);
+
+            while (next_samples <= samples)
+                next_samples *= 2;
+            while (next_time <= seconds)
+                next_time += CHECKPOINT_SECONDS;
+        }
+    }
+
+    if (context.debug_counters && !write_debug_counters(context, options.debug_counters))
+    {
+        std::cerr << "failed to write " << options.debug_counters << "_*.pfm" << std::endl;
+        return 1;
+    }
+
+    if (has_reference)
+        return 0;
+
+    read_estimate(context, rgba, image);
+    if (!write_pfm(options.reference, image))
+    {
+        std::cerr << "failed to write " << options.reference << std::endl;
+        return 1;
+    }
+
+    std::cerr << "wrote reference " << options.reference << " with " << options.samples << " spp in " << seconds
+            << " s" << std::endl;
+    return 0;
+}
+
+// the child sees the same binary, so every scene starts from a fresh context and program set
+static bool run_child(const std::vector<std::string> &arguments)
+{
+    const auto pid = fork();
+    if (pid < 0)
+        return false;
+
+    if (!pid)
+    {
+        std::vector<const char *> args{ "glrt" };
+        for (auto &argument : arguments)
+            args.push_back(argument.c_str());
+        args.push_back(nullptr);
+
+        execv("/proc/self/exe", const_cast<char *const *>(args.data()));
+        _exit(127);
+    }
+
+    int status;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status);
+}
+
+static std::string last_line(const std::filesystem::path &path)
+{
+    std::ifstream stream(path);
+
+    std::string line, last;
+    while (std::getline(stream, line))
+        if (!line.empty())
+            last = line;
+    return last;
+}
+
+int run_benchmark_suite(const options_t &options)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(options.reference, ec);
+
+    std::vector<std::string> summary;
+    auto failed = false;
+
+    for (const auto &[name, scene] : BENCHMARK_SCENES)
+    {
+        const auto reference = options.reference / (std::string(name) + ".pfm");
+        const auto curve = options.reference / (std::string(name) + ".csv");
+
+        std::vector<std::string> common{ "--size", BENCHMARK_SIZE };
+        if (*scene)
+            common.insert(common.end(), { "--scene", scene });
+        if (options.threads)
+            common.insert(common.end(), { "--threads", std::to_string(options.threads) });
+
+        // references ignore the settings under test, so one set serves every configuration
+        if (!std::filesystem::exists(reference))
+        {
+            std::cerr << name << ": rendering reference at " << REFERENCE_SAMPLES << " spp" << std::endl;
+
+            auto arguments = common;
+            arguments.insert(
+                arguments.end(),
+                { "--benchmark", reference.string(), "--samples", std::to_string(REFERENCE_SAMPLES) });
+
+            if (!run_child(arguments))
+            {
+                std::cerr << name << ": failed to render reference" << std::endl;
+                failed = true;
+                continue;
+            }
+        }
+
+        auto arguments = common;
+        arguments.insert(
+            arguments.end(),
+            {
+                "--benchmark", reference.string(),
+                "--curve", curve.string(),
+                "--samples", std::to_string(options.samples),
+                "--spatial-splits", std::to_string(options.split_budget),
+                "--bvh-nodes", options.compact_nodes ? "compact" : "full",
+                "--primary", options.raster_primary ? "raster" : "trace",
+                "--direct", options.restir ? "restir" : "nee",
+            });
+
+        std::cerr << name << ": benchmarking" << std::endl;
+        if (!run_child(arguments))
+        {
+            std::cerr << name << ": benchmark failed" << std::endl;
+            failed = true;
+            continue;
+        }
+
+        summary.push_back(std::string(name) + "," + last_line(curve));
+    }
+
+    std::cerr << "scene,samples,seconds,rmse,relmse" << std::endl;
+    for (auto &line : summary)
+        std::cerr << line << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -1,6 +1,12 @@
 #include <algorithm>
 #include <limits>
+#include <utility>
 #include <glrt/bvh.hxx>
+#include <glrt/jobs.hxx>
+#include <glrt/kernel.hxx>
+#include <glrt/trace.hxx>
+
+static constexpr std::size_t SETUP_GRAIN = 4096;
 
 box_t box_union(const box_t &a, const box_t &b)
 {
@@ -10,6 +16,36 @@ box_t box_union(const box_t &a, const box_t &b)
     };
 }
 
+box_t box_union(const box_t &a, const vec3f &p)
+{
+    return {
+        min(a.min, p),
+        max(a.max, p)
+    };
+}
+
+box_t box_intersection(const box_t &a, const box_t &b)
+{
+    return {
+        max(a.min, b.min),
+        min(a.max, b.max)
+    };
+}
+
+bool box_valid(const box_t &box)
+{
+    return box.min[0] <= box.max[0] && box.min[1] <= box.max[1] && box.min[2] <= box.max[2];
+}
+
+float box_area(const box_t &box)
+{
+    if (!box_valid(box))
+        return 0.0f;
+
+    const auto extent = box.max - box.min;
+    return 2.0f * (extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0]);
+}
+
 box_t box_empty()
 {
     constexpr auto infinity = std::numeric_limits<float>::infinity();
@@ -26,15 +62,8 @@ std::uint32_t build_bvh_node(
     const std::uint32_t begin,
     const std::uint32_t end)
 {
-    auto bounds = box_empty();
-    auto centroid_bounds = box_empty();
-
-    for (auto i = begin; i < end; ++i)
-    {
-        bounds = box_union(bounds, triangles[i].bounds);
-        centroid_bounds.min = min(centroid_bounds.min, triangles[i].centroid);
-        centroid_bounds.max = max(centroid_bounds.max, triangles[i].centroid);
-    }
+    box_t bounds, centroid_bounds;
+    triangle_bounds(triangles.data() + begin, end - begin, bounds, centroid_bounds);
 
     const auto node_index = static_cast<std::uint32_t>(nodes.size());
     nodes.emplace_back();
@@ -80,55 +109,89 @@ std::uint32_t build_bvh_node(
     return node_index;
 }
 
-void build_bvh(const model_t &model, bvh_t &tree)
+void build_bvh(const model_t &model, bvh_t &tree, const bvh_options_t &options)
 {
-    std::vector<triangle_t> triangles;
+    const trace_zone_t zone("build_bvh");
 
-    tree.lights.clear();
-    tree.light_areas.clear();
-    tree.total_light_area = {};
+    const auto triangle_count = model.indices.size() / 3;
 
-    for (std::uint32_t i = 0; i < model.indices.size(); i += 3)
-    {
-        const auto i0 = model.indices[i + 0];
-        const auto i1 = model.indices[i + 1];
-        const auto i2 = model.indices[i + 2];
-
-        auto &p0 = model.vertices[i0].position;
-        auto &p1 = model.vertices[i1].position;
-        auto &p2 = model.vertices[i2].position;
+    std::vector<triangle_t> triangles(triangle_count);
+    std::vector<float> emitting_areas(triangle_count);
 
-        const box_t bounds
-        {
-            .min = min(p0, min(p1, p2)),
-            .max = max(p0, max(p1, p2)),
-        };
+    {
+        const trace_zone_t zone("build_bvh setup");
 
-        triangles.push_back(
+        jobs().parallel_for(
+            0,
+            triangle_count,
+            SETUP_GRAIN,
+            [&](const std::size_t begin, const std::size_t end)
             {
-                .index = i,
-                .bounds = bounds,
-                .centroid = (p0 + p1 + p2) / 3.0f,
+                for (auto t = begin; t < end; ++t)
+                {
+                    const auto i = static_cast<std::uint32_t>(t * 3);
+                    const auto i0 = model.indices[i + 0];
+                    const auto i1 = model.indices[i + 1];
+                    const auto i2 = model.indices[i + 2];
+
+                    auto &p0 = model.vertices[i0].position;
+                    auto &p1 = model.vertices[i1].position;
+                    auto &p2 = model.vertices[i2].position;
+
+                    const box_t bounds
+                    {
+                        .min = min(p0, min(p1, p2)),
+                        .max = max(p0, max(p1, p2)),
+                    };
+
+                    triangles[t] = {
+                        .index = i,
+                        .bounds = bounds,
+                        .centroid = (p0 + p1 + p2) / 3.0f,
+                    };
+
+                    if (auto &material = model.materials[model.vertices[i0].material]; material.is_emissive())
+                        emitting_areas[t] = triangle_area(p0, p1, p2);
+                }
             });
 
-        if (auto &material = model.materials[model.vertices[i0].material]; !material.is_emissive())
-            continue;
+        tree.lights.clear();
+        tree.light_areas.clear();
+        tree.total_light_area = {};
 
-        auto area = triangle_area(p0, p1, p2);
-        if (area <= 0.0f)
-            continue;
+        // compacted in index order, so the light list and its running sum match a serial build exactly
+        for (std::size_t t = 0; t < triangle_count; ++t)
+        {
+            const auto area = emitting_areas[t];
+            if (area <= 0.0f)
+                continue;
 
-        tree.lights.push_back(i);
-        tree.light_areas.push_back(area);
+            tree.lights.push_back(triangles[t].index);
+            tree.light_areas.push_back(area);
 
-        tree.total_light_area += area;
+            tree.total_light_area += area;
+        }
     }
 
     tree.nodes.clear();
     tree.nodes.reserve(triangles.size() * 2);
+
+    if (options.split_budget > 0.0f)
+    {
+        build_sbvh(model, std::move(triangles), options.split_budget, tree);
+        return;
+    }
+
     build_bvh_node(tree.nodes, triangles, 0, triangles.size());
 
     tree.map.resize(triangles.size());
-    for (unsigned i = 0; i < triangles.size(); ++i)
-        tree.map[i] = triangles[i].index;
+    jobs().parallel_for(
+        0,
+        triangles.size(),
+        SETUP_GRAIN,
+        [&](const std::size_t begin, const std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                tree.map[i] = triangles[i].index;
+        });
 }
@@ -0,0 +1,21 @@
+#include <cmath>
+#include <glrt/camera.hxx>
+
+vec3f camera_forward(const camera_t &camera)
+{
+    return {
+        std::sin(camera.yaw) * std::cos(camera.pitch),
+        std::sin(camera.pitch),
+        -std::cos(camera.yaw) * std::cos(camera.pitch),
+    };
+}
+
+vec3f camera_right(const camera_t &camera)
+{
+    return { std::cos(camera.yaw), 0.0f, std::sin(camera.yaw) };
+}
+
+mat4f camera_view(const camera_t &camera)
+{
+    return lookAt(camera.position, camera.position + camera_forward(camera), { 0.0f, 1.0f, 0.0f });
+}
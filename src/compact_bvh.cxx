@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <glrt/bvh.hxx>
+#include <glrt/trace.hxx>
+
+constexpr std::uint32_t QUANTIZE_MAX = 0xff;
+constexpr std::uint32_t EXPONENT_BIAS = 127;
+
+static bool is_leaf(const bvh_node_t &node)
+{
+    return node.begin != node.end || node.left == 0xffffffffu;
+}
+
+static box_t node_bounds(const bvh_node_t &node)
+{
+    return { node.box_min, node.box_max };
+}
+
+static float exponent_scale(const std::uint32_t exponent)
+{
+    return std::bit_cast<float>(exponent << 23);
+}
+
+// must round exactly like the shader: the product is exact, so only the add rounds
+static float dequantize(const float origin, const std::uint32_t q, const float scale)
+{
+    return origin + static_cast<float>(q) * scale;
+}
+
+static std::uint32_t quantize_byte(const std::uint32_t bounds, const unsigned child, const bool max)
+{
+    return (bounds >> (child * 16 + (max ? 8 : 0))) & QUANTIZE_MAX;
+}
+
+box_t dequantize_child(const compact_bvh_node_t &node, const unsigned child)
+{
+    box_t box;
+    for (unsigned axis = 0; axis < 3; ++axis)
+    {
+        const auto scale = exponent_scale((node.meta >> (axis * 8)) & 0xff);
+        box.min[axis] = dequantize(node.origin[axis], quantize_byte(node.bounds[axis], child, false), scale);
+        box.max[axis] = dequantize(node.origin[axis], quantize_byte(node.bounds[axis], child, true), scale);
+    }
+    return box;
+}
+
+// quantizes both children on one axis, rounding outward and checking the shader's dequantization;
+// fails when the top of the grid does not reach the children, so the caller can coarsen the scale
+static bool quantize_axis(
+    const float origin,
+    const std::uint32_t exponent,
+    const box_t (&children)[2],
+    const unsigned axis,
+    std::uint32_t &bounds)
+{
+    const auto scale = exponent_scale(exponent);
+
+    bounds = 0;
+    for (unsigned child = 0; child < 2; ++child)
+    {
+        const auto lo_value = children[child].min[axis];
+        const auto hi_value = children[child].max[axis];
+
+        // nan compares false against every grid value and would pass the checks below unenclosed
+        if (std::isnan(lo_value) || std::isnan(hi_value))
+            return false;
+
+        auto lo = static_cast<std::uint32_t>(std::clamp(std::floor((lo_value - origin) / scale), 0.0f, 255.0f));
+        auto hi = static_cast<std::uint32_t>(std::clamp(std::ceil((hi_value - origin) / scale), 0.0f, 255.0f));
+
+        while (lo > 0 && dequantize(origin, lo, scale) > lo_value)
+            --lo;
+        while (hi < QUANTIZE_MAX && dequantize(origin, hi, scale) < hi_value)
+            ++hi;
+
+        if (dequantize(origin, lo, scale) > lo_value || dequantize(origin, hi, scale) < hi_value)
+            return false;
+
+        bounds |= (lo | hi << 8) << (child * 16);
+    }
+    return true;
+}
+
+// fails when even the coarsest scale cannot enclose the children, as with nan bounds
+static bool quantize_node(const box_t &bounds, const box_t (&children)[2], compact_bvh_node_t &node)
+{
+    node = { .origin = bounds.min };
+
+    for (unsigned axis = 0; axis < 3; ++axis)
+    {
+        int e;
+        std::frexp((bounds.max[axis] - bounds.min[axis]) / static_cast<float>(QUANTIZE_MAX), &e);
+
+        auto exponent = static_cast<std::uint32_t>(std::clamp(e + static_cast<int>(EXPONENT_BIAS), 1, 254));
+        while (!quantize_axis(node.origin[axis], exponent, children, axis, node.bounds[axis]))
+            if (++exponent > 254)
+                return false;
+
+        node.meta |= exponent << (axis * 8);
+    }
+
+    return true;
+}
+
+static bool compact_bvh_node(const bvh_t &tree, const std::uint32_t index, std::vector<compact_bvh_node_t> &nodes)
+{
+    const auto &node = tree.nodes[index];
+    const auto &left = tree.nodes[node.left];
+    const auto &right = tree.nodes[node.right];
+
+    const auto slot = nodes.size();
+    nodes.emplace_back();
+
+    const box_t children[2]{ node_bounds(left), node_bounds(right) };
+    compact_bvh_node_t compact;
+    if (!quantize_node(box_union(children[0], children[1]), children, compact))
+        return false;
+
+    const auto left_count = is_leaf(left) ? left.end - left.begin : COMPACT_INNER;
+    const auto right_count = is_leaf(right) ? right.end - right.begin : COMPACT_INNER;
+    compact.meta |= (left_count | right_count << 4) << 24;
+
+    if (!is_leaf(left) && !compact_bvh_node(tree, node.left, nodes))
+        return false;
+
+    if (!is_leaf(right))
+    {
+        const auto right_index = static_cast<std::uint32_t>(nodes.size());
+        if (!compact_bvh_node(tree, node.right, nodes))
+            return false;
+
+        if (!is_leaf(left))
+            compact.link = right_index;
+    }
+
+    if (is_leaf(left))
+        compact.link = left.begin;
+    else if (is_leaf(right))
+        compact.link = right.begin;
+
+    nodes[slot] = compact;
+    return true;
+}
+
+bool compact_bvh(bvh_t &tree)
+{
+    const trace_zone_t zone("compact_bvh");
+
+    tree.compact_nodes.clear();
+
+    if (tree.nodes.empty())
+        return true;
+
+    const auto &root = tree.nodes[0];
+    if (!is_leaf(root))
+    {
+        tree.compact_nodes.reserve(tree.nodes.size() / 2 + 1);
+        if (compact_bvh_node(tree, 0, tree.compact_nodes))
+            return true;
+
+        tree.compact_nodes.clear();
+        return false;
+    }
+
+    if (root.begin == root.end)
+    {
+        tree.compact_nodes.emplace_back();
+        return true;
+    }
+
+    // a single leaf still needs a parent frame; the empty right child holds no triangles
+    const box_t children[2]{ node_bounds(root), node_bounds(root) };
+    compact_bvh_node_t compact;
+    if (!quantize_node(children[0], children, compact))
+        return false;
+
+    compact.meta |= (root.end - root.begin) << 24;
+    compact.link = root.begin;
+    tree.compact_nodes.push_back(compact);
+    return true;
+}
@@ -0,0 +1,802 @@
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glrt/context.hxx>
+#include <glrt/image.hxx>
+#include <glrt/sobol.hxx>
+#include <glrt/trace.hxx>
+
+void upload_scene(context_t &context, const model_t &model, const bvh_t &bvh)
+{
+    const trace_zone_t zone("upload_scene");
+    const gpu_zone_t gpu_zone("upload_scene");
+
+    context.data.total_light_area = bvh.total_light_area;
+    context.index_count = static_cast<std::uint32_t>(model.indices.size());
+
+    context.data_buffer.Bind(GL_UNIFORM_BUFFER, 0);
+
+    context.index_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 1);
+    context.vertex_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 2);
+    context.material_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 3);
+    context.node_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 4);
+    context.map_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 5);
+    context.light_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 6);
+    context.light_area_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 7);
+    context.sobol_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 8);
+    context.compact_node_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 9);
+    context.page_table_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 10);
+    context.page_node_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 11);
+    context.page_vertex_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 12);
+    context.page_request_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 13);
+    context.environment_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 14);
+    context.restir_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 15);
+    context.debug_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 16);
+
+    context.index_buffer.Data(
+        model.indices.data(),
+        model.indices.size() * sizeof(std::uint32_t),
+        GL_STATIC_DRAW);
+    context.vertex_buffer.Data(
+        model.vertices.data(),
+        model.vertices.size() * sizeof(vertex_t),
+        GL_STATIC_DRAW);
+    context.material_buffer.Data(
+        model.materials.data(),
+        model.materials.size() * sizeof(material_t),
+        GL_STATIC_DRAW);
+
+    // only the node layout the shader was specialized for is uploaded
+    if (bvh.compact_nodes.empty())
+        context.node_buffer.Data(
+            bvh.nodes.data(),
+            bvh.nodes.size() * sizeof(bvh_node_t),
+            GL_STATIC_DRAW);
+    else
+        context.compact_node_buffer.Data(
+            bvh.compact_nodes.data(),
+            bvh.compact_nodes.size() * sizeof(compact_bvh_node_t),
+            GL_STATIC_DRAW);
+
+    context.map_buffer.Data(
+        bvh.map.data(),
+        bvh.map.size() * sizeof(std::uint32_t),
+        GL_STATIC_DRAW);
+    context.light_buffer.Data(
+        bvh.lights.data(),
+        bvh.lights.size() * sizeof(std::uint32_t),
+        GL_STATIC_DRAW);
+    context.light_area_buffer.Data(
+        bvh.light_areas.data(),
+        bvh.light_areas.size() * sizeof(std::uint32_t),
+        GL_STATIC_DRAW);
+
+    std::vector<std::uint32_t> sobol_directions;
+    build_sobol_directions(sobol_directions);
+
+    context.sobol_buffer.Data(
+        sobol_directions.data(),
+        sobol_directions.size() * sizeof(std::uint32_t),
+        GL_STATIC_DRAW);
+}
+
+void load_programs(context_t &context, const variant_t &variant, gl::Error &error)
+{
+    const trace_zone_t zone("load_programs");
+
+    const gl::ProgramCache program_cache("cache/program");
+
+    // every program links into a fresh object and only replaces the context's once all of them have; a failed
+    // reload keeps rendering with the old set, and a relink never sees the shaders of an earlier link
+    gl::Program draw_program;
+    gl::Program compute_program;
+    gl::Program reproject_program;
+    gl::Program restir_initial_program;
+    gl::Program restir_spatial_program;
+    gl::Program gbuffer_program;
+
+    if (program_cache.Load(
+        draw_program,
+        {
+            { "asset/shader/default.vert.spv", GL_VERTEX_SHADER },
+            { "asset/shader/default.frag.spv", GL_FRAGMENT_SHADER },
+        },
+        error); error)
+        return;
+
+    if (draw_program.Validate(error); error)
+        return;
+
+    if (program_cache.Load(
+        compute_program,
+        {
+            {
+                "asset/shader/default.comp.spv",
+                GL_COMPUTE_SHADER,
+                {
+                    { SPEC_LOBES, variant.lobes },
+                    { SPEC_MAX_BOUNCES, variant.max_bounces },
+                    { SPEC_LEAF_SIZE, variant.leaf_size },
+                    { SPEC_PASS, PASS_TRACE },
+                    { SPEC_COMPACT_NODES, variant.compact_nodes },
+                    { SPEC_RASTER_PRIMARY, variant.raster_primary },
+                    { SPEC_PAGED, variant.paged },
+                    { SPEC_ENVIRONMENT, variant.environment },
+                    { SPEC_RESTIR, variant.restir },
+                    { SPEC_DEBUG_COUNTERS, variant.debug_counters },
+                },
+            },
+        },
+        error); error)
+        return;
+
+    if (compute_program.Validate(error); error)
+        return;
+
+    if (program_cache.Load(
+        reproject_program,
+        {
+            {
+                "asset/shader/default.comp.spv",
+                GL_COMPUTE_SHADER,
+                {
+                    { SPEC_LEAF_SIZE, variant.leaf_size },
+                    { SPEC_PASS, PASS_REPROJECT },
+                    { SPEC_COMPACT_NODES, variant.compact_nodes },
+                    { SPEC_PAGED, variant.paged },
+                },
+            },
+        },
+        error); error)
+        return;
+
+    if (reproject_program.Validate(error); error)
+        return;
+
+    if (variant.restir)
+    {
+        for (auto [program, pass] : {
+                 std::pair{ &restir_initial_program, PASS_RESTIR_INITIAL },
+                 std::pair{ &restir_spatial_program, PASS_RESTIR_SPATIAL },
+             })
+        {
+            if (program_cache.Load(
+                *program,
+                {
+                    {
+                        "asset/shader/default.comp.spv",
+                        GL_COMPUTE_SHADER,
+                        {
+                            { SPEC_LOBES, variant.lobes },
+                            { SPEC_MAX_BOUNCES, variant.max_bounces },
+                            { SPEC_LEAF_SIZE, variant.leaf_size },
+                            { SPEC_PASS, pass },
+                            { SPEC_COMPACT_NODES, variant.compact_nodes },
+                            { SPEC_RASTER_PRIMARY, variant.raster_primary },
+                        },
+                    },
+                },
+                error); error)
+                return;
+
+            if (program->Validate(error); error)
+                return;
+        }
+    }
+
+    if (variant.raster_primary)
+    {
+        if (program_cache.Load(
+            gbuffer_program,
+            {
+                { "asset/shader/gbuffer.vert.spv", GL_VERTEX_SHADER },
+                { "asset/shader/gbuffer.frag.spv", GL_FRAGMENT_SHADER },
+            },
+            error); error)
+            return;
+
+        if (gbuffer_program.Validate(error); error)
+            return;
+    }
+
+    context.draw_program = std::move(draw_program);
+    context.compute_program = std::move(compute_program);
+    context.reproject_program = std::move(reproject_program);
+    context.restir_initial_program = std::move(restir_initial_program);
+    context.restir_spatial_program = std::move(restir_spatial_program);
+    context.gbuffer_program = std::move(gbuffer_program);
+
+    context.raster_primary = variant.raster_primary;
+    context.paged = variant.paged;
+    context.restir = variant.restir;
+    context.debug_counters = variant.debug_counters;
+    context.max_bounces = variant.max_bounces;
+    context.variant = variant;
+}
+
+bool upload_pages(
+    context_t &context,
+    const std::filesystem::path &path,
+    const std::uint32_t page_count,
+    const std::uint32_t slot_count)
+{
+    auto &cache = context.pages;
+    if (!open_page_cache(cache, path, page_count, slot_count))
+        return false;
+
+    context.data.page_words = (page_count + 31) / 32;
+
+    context.page_table_buffer.Data(
+        cache.page_slots.data(),
+        cache.page_slots.size() * sizeof(std::uint32_t),
+        GL_DYNAMIC_DRAW);
+    context.page_node_buffer.Data(
+        nullptr,
+        static_cast<std::size_t>(cache.slot_count) * PAGE_NODES * sizeof(bvh_node_t),
+        GL_DYNAMIC_DRAW);
+    context.page_vertex_buffer.Data(
+        nullptr,
+        static_cast<std::size_t>(cache.slot_count) * PAGE_TRIANGLES * 3 * sizeof(vertex_t),
+        GL_DYNAMIC_DRAW);
+
+    const std::vector<std::uint32_t> requests(context.data.page_words * 2);
+    context.page_request_buffer.Data(
+        requests.data(),
+        requests.size() * sizeof(std::uint32_t),
+        GL_DYNAMIC_READ);
+
+    return true;
+}
+
+void upload_environment(context_t &context, const environment_t &environment)
+{
+    const trace_zone_t zone("upload_environment");
+    const gpu_zone_t gpu_zone("upload_environment");
+
+    context.data.environment_width = environment.width;
+
+    context.environment_buffer.Data(
+        environment.texels.data(),
+        environment.texels.size() * sizeof(environment_texel_t),
+        GL_STATIC_DRAW);
+}
+
+template<typename T>
+static void upload_dirty(const gl::Buffer &buffer, const std::vector<T> &data, const dirty_ranges_t &dirty)
+{
+    // the buffer mirrors the vector's capacity, so it only regrows when the vector does. the shader sizes
+    // light_areas by the buffer, so the tail must read as zero
+    if (buffer.Size() < data.capacity() * sizeof(T))
+    {
+        constexpr std::uint32_t zero = 0;
+        buffer.Data(nullptr, data.capacity() * sizeof(T), GL_DYNAMIC_DRAW);
+        buffer.Clear(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        buffer.SubData(0, data.data(), data.size() * sizeof(T));
+        return;
+    }
+
+    for (const auto &[begin, end] : dirty.ranges())
+        buffer.SubData(begin * sizeof(T), data.data() + begin, (std::min(end, data.size()) - begin) * sizeof(T));
+}
+
+void reserve_edits(context_t &context, const editable_scene_t &scene)
+{
+    const dirty_ranges_t none;
+
+    upload_dirty(context.index_buffer, scene.model.indices, none);
+    upload_dirty(context.vertex_buffer, scene.model.vertices, none);
+    upload_dirty(context.material_buffer, scene.model.materials, none);
+    upload_dirty(context.node_buffer, scene.bvh.nodes, none);
+    upload_dirty(context.map_buffer, scene.bvh.map, none);
+    upload_dirty(context.light_buffer, scene.bvh.lights, none);
+    upload_dirty(context.light_area_buffer, scene.bvh.light_areas, none);
+}
+
+static void restart_accumulation(context_t &context);
+
+void upload_edits(context_t &context, editable_scene_t &scene, gl::Error &error)
+{
+    if (!has_edits(scene))
+        return;
+
+    const trace_zone_t zone("upload_edits");
+    const gpu_zone_t gpu_zone("upload_edits");
+
+    // lobes are only ever added: a superset still renders correctly, and dropping one would recompile on every
+    // remove and re-add
+    if (const auto lobes = select_variant(scene.model).lobes; lobes & ~context.variant.lobes)
+    {
+        auto variant = context.variant;
+        variant.lobes |= lobes;
+
+        if (load_programs(context, variant, error); error)
+            return;
+    }
+
+    upload_dirty(context.index_buffer, scene.model.indices, scene.dirty_indices);
+    upload_dirty(context.vertex_buffer, scene.model.vertices, scene.dirty_vertices);
+    upload_dirty(context.material_buffer, scene.model.materials, scene.dirty_materials);
+    upload_dirty(context.node_buffer, scene.bvh.nodes, scene.dirty_nodes);
+    upload_dirty(context.map_buffer, scene.bvh.map, scene.dirty_map);
+    upload_dirty(context.light_buffer, scene.bvh.lights, scene.dirty_lights);
+    upload_dirty(context.light_area_buffer, scene.bvh.light_areas, scene.dirty_lights);
+
+    for (auto dirty : { &scene.dirty_indices,
+                        &scene.dirty_vertices,
+                        &scene.dirty_materials,
+                        &scene.dirty_nodes,
+                        &scene.dirty_map,
+                        &scene.dirty_lights })
+        dirty->clear();
+
+    context.data.total_light_area = scene.bvh.total_light_area;
+    context.index_count = static_cast<std::uint32_t>(scene.model.indices.size());
+
+    restart_accumulation(context);
+}
+
+// reads back the miss and usage masks of the last dispatch and streams missing pages into least recently used
+// slots; returns whether the dispatch has to be repeated for the paths that missed
+static bool stream_pages(context_t &context)
+{
+    auto &cache = context.pages;
+    const auto words = context.data.page_words;
+
+    std::vector<std::uint32_t> requests(static_cast<std::size_t>(words) * 2);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    context.page_request_buffer.GetSubData(0, requests.data(), requests.size() * sizeof(std::uint32_t));
+
+    constexpr std::uint32_t zero = 0;
+    context.page_request_buffer.Clear(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    for (std::uint32_t word = 0; word < words; ++word)
+        for (auto bits = requests[words + word]; bits; bits &= bits - 1)
+            if (const auto slot = cache.page_slots[word * 32 + std::countr_zero(bits)]; slot != PAGE_NONE)
+                cache.slot_clock[slot] = cache.clock;
+
+    auto missed = false;
+    std::unique_ptr<page_t> page;
+
+    for (std::uint32_t word = 0; word < words; ++word)
+    {
+        for (auto bits = requests[word]; bits; bits &= bits - 1)
+        {
+            const auto index = word * 32 + static_cast<std::uint32_t>(std::countr_zero(bits));
+            missed = true;
+
+            if (cache.page_slots[index] != PAGE_NONE)
+                continue;
+
+            // every slot holds a page this dispatch touched; loading more would evict the working set
+            const auto slot = evict_slot(cache);
+            if (cache.slot_clock[slot] == cache.clock)
+                break;
+
+            if (!page)
+                page = std::make_unique<page_t>();
+            if (!read_page(cache, index, *page))
+                continue;
+
+            if (const auto old = cache.slot_pages[slot]; old != PAGE_NONE)
+            {
+                cache.page_slots[old] = PAGE_NONE;
+                context.page_table_buffer.SubData(old * sizeof(std::uint32_t), &PAGE_NONE, sizeof(std::uint32_t));
+            }
+
+            context.page_node_buffer.SubData(
+                static_cast<std::size_t>(slot) * PAGE_NODES * sizeof(bvh_node_t),
+                page->nodes,
+                page->header.node_count * sizeof(bvh_node_t));
+            context.page_vertex_buffer.SubData(
+                static_cast<std::size_t>(slot) * PAGE_TRIANGLES * 3 * sizeof(vertex_t),
+                page->vertices,
+                page->header.triangle_count * 3 * sizeof(vertex_t));
+
+            cache.page_slots[index] = slot;
+            cache.slot_pages[slot] = index;
+            cache.slot_clock[slot] = cache.clock;
+            context.page_table_buffer.SubData(index * sizeof(std::uint32_t), &slot, sizeof(std::uint32_t));
+        }
+    }
+
+    cache.clock++;
+
+    if (!missed || ++cache.retries > PAGE_RETRIES)
+    {
+        // a path is re-traced from the camera, so it completes only with every page it touches resident at once; a
+        // budget below that drops the same paths every sample and leaves their pixels dark
+        if (missed && !cache.dropped)
+        {
+            cache.dropped = true;
+            std::cerr << "paths still missed pages after " << PAGE_RETRIES << " retries and were dropped; the cache holds "
+                    << cache.slot_count << " of " << cache.page_count << " pages" << std::endl;
+        }
+
+        cache.retries = 0;
+        return false;
+    }
+    return true;
+}
+
+static void bind_images(const context_t &context)
+{
+    context.accumulation.BindImage(0, 0, false, 0, GL_READ_WRITE, GL_RGBA32F);
+    context.guide.BindImage(1, 0, false, 0, GL_READ_WRITE, GL_RGBA32F);
+    context.history.BindImage(2, 0, false, 0, GL_READ_ONLY, GL_RGBA32F);
+    context.history_guide.BindImage(3, 0, false, 0, GL_READ_ONLY, GL_RGBA32F);
+
+    if (context.raster_primary)
+    {
+        context.gbuffer_position.BindImage(4, 0, false, 0, GL_READ_ONLY, GL_RGBA32F);
+        context.gbuffer_normal.BindImage(5, 0, false, 0, GL_READ_ONLY, GL_RGBA32F);
+        context.gbuffer_surface.BindImage(6, 0, false, 0, GL_READ_ONLY, GL_RGBA32F);
+    }
+
+    if (context.paged)
+        context.sample_state.BindImage(7, 0, false, 0, GL_READ_WRITE, GL_R32UI);
+}
+
+static float radical_inverse(std::uint32_t index, const std::uint32_t base)
+{
+    auto result = 0.0f;
+    for (auto f = 1.0f / static_cast<float>(base); index; index /= base, f /= static_cast<float>(base))
+        result += f * static_cast<float>(index % base);
+    return result;
+}
+
+// rasterizes first hits for one sample; every tile of that sample shares the same subpixel jitter
+static void draw_gbuffer(context_t &context, const std::uint32_t sample)
+{
+    context.gbuffer_sample = sample;
+    context.data.jitter = {
+        radical_inverse(sample + 1, 2) - 0.5f,
+        radical_inverse(sample + 1, 3) - 0.5f,
+    };
+
+    context.data_buffer.Data(
+        &context.data,
+        sizeof(uniform_data_t),
+        GL_STATIC_DRAW);
+
+    constexpr float miss[4]{ 0.0f, 0.0f, 0.0f, -1.0f };
+    constexpr float zero[4]{};
+    context.gbuffer.ClearColor(0, miss);
+    context.gbuffer.ClearColor(1, zero);
+    context.gbuffer.ClearColor(2, zero);
+    context.gbuffer.ClearDepth(1.0f);
+
+    context.gbuffer.Bind(GL_FRAMEBUFFER);
+    context.vertex_array.Bind();
+    context.gbuffer_program.Bind();
+
+    glViewport(0, 0, static_cast<GLsizei>(context.data.extent[0]), static_cast<GLsizei>(context.data.extent[1]));
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(context.index_count));
+
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// resamples direct light for one sample over the whole image: initial candidates with temporal history, then
+// spatial reuse into the history reservoirs the trace pass shades from
+static void resample_direct(context_t &context, const std::uint32_t sample)
+{
+    context.restir_sample = sample;
+
+    const auto groups = (vec2u(context.data.extent.swizzle<0, 1>()) + 7u) / 8u;
+
+    for (auto program : { &context.restir_initial_program, &context.restir_spatial_program })
+    {
+        program->Bind();
+        glDispatchCompute(
+            groups[0],
+            groups[1],
+            1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+}
+
+static void clear_reservoirs(const context_t &context)
+{
+    constexpr std::uint32_t zero = 0;
+    context.restir_buffer.Clear(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+}
+
+static void resize_reservoirs(context_t &context, const std::uint32_t width, const std::uint32_t height)
+{
+    const auto pixels = static_cast<std::size_t>(width) * height;
+
+    context.restir_buffer.Data(nullptr, pixels * sizeof(restir_pixel_t), GL_DYNAMIC_COPY);
+
+    clear_reservoirs(context);
+    context.restir_sample = 0xffffffffu;
+}
+
+static void resize_gbuffer(context_t &context, const std::uint32_t width, const std::uint32_t height)
+{
+    for (auto texture : { &context.gbuffer_position, &context.gbuffer_normal, &context.gbuffer_surface })
+    {
+        texture->Recreate(GL_TEXTURE_2D);
+        texture->Storage2D(1, GL_RGBA32F, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    }
+
+    context.gbuffer_depth.Recreate(GL_TEXTURE_2D);
+    context.gbuffer_depth.Storage2D(1, GL_DEPTH_COMPONENT32F, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+
+    context.gbuffer.Attach(GL_COLOR_ATTACHMENT0, context.gbuffer_position, 0);
+    context.gbuffer.Attach(GL_COLOR_ATTACHMENT1, context.gbuffer_normal, 0);
+    context.gbuffer.Attach(GL_COLOR_ATTACHMENT2, context.gbuffer_surface, 0);
+    context.gbuffer.Attach(GL_DEPTH_ATTACHMENT, context.gbuffer_depth, 0);
+    context.gbuffer.DrawBuffers({ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 });
+    context.gbuffer_sample = 0xffffffffu;
+}
+
+void resize_accumulation(context_t &context, const std::uint32_t width, const std::uint32_t height)
+{
+    context.data.extent = {
+        width,
+        height,
+        context.data.extent[2],
+    };
+    context.data.frame = {};
+    context.data.sample_offset = {};
+
+    context.proj = perspective(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 100.0f);
+    context.data.inv_proj = inverse(context.proj);
+    context.data.view_proj = context.proj * context.view;
+    context.data.prev_view_proj = context.data.view_proj;
+
+    constexpr float zero[4]{};
+    for (auto texture : { &context.accumulation, &context.guide, &context.history, &context.history_guide })
+    {
+        texture->Recreate(GL_TEXTURE_2D);
+        texture->Storage2D(1, GL_RGBA32F, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+        texture->ClearSubImage(
+            0,
+            0,
+            0,
+            static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height),
+            GL_RGBA,
+            GL_FLOAT,
+            zero);
+    }
+
+    if (context.raster_primary)
+        resize_gbuffer(context, width, height);
+
+    if (context.restir)
+        resize_reservoirs(context, width, height);
+
+    // running means start over with the first sample and need no clearing; the paged carry behind them does
+    if (context.debug_counters)
+    {
+        constexpr float zero[4]{};
+        const auto entries = static_cast<std::size_t>(width) * height * (context.paged ? 2 : 1);
+        context.debug_buffer.Data(nullptr, entries * 4 * sizeof(float), GL_DYNAMIC_COPY);
+        context.debug_buffer.Clear(GL_RGBA32F, GL_RGBA, GL_FLOAT, zero);
+    }
+
+    if (context.paged)
+    {
+        constexpr std::uint32_t none = 0;
+        context.sample_state.Recreate(GL_TEXTURE_2D);
+        context.sample_state.Storage2D(1, GL_R32UI, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+        context.sample_state.ClearSubImage(
+            0,
+            0,
+            0,
+            static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height),
+            GL_RED_INTEGER,
+            GL_UNSIGNED_INT,
+            &none);
+    }
+
+    bind_images(context);
+}
+
+// samples of the old scene are wrong for the new one; nothing is reprojected across an edit
+static void restart_accumulation(context_t &context)
+{
+    const auto width = static_cast<GLsizei>(context.data.extent[0]);
+    const auto height = static_cast<GLsizei>(context.data.extent[1]);
+
+    constexpr float zero[4]{};
+    for (auto texture : { &context.accumulation, &context.guide, &context.history, &context.history_guide })
+        texture->ClearSubImage(0, 0, 0, width, height, GL_RGBA, GL_FLOAT, zero);
+
+    context.data.frame = {};
+    context.data.sample_offset = {};
+    context.gbuffer_sample = 0xffffffffu;
+
+    if (context.restir)
+    {
+        clear_reservoirs(context);
+        context.restir_sample = 0xffffffffu;
+    }
+}
+
+void set_camera(context_t &context, const mat4f &view, const vec3f &origin)
+{
+    context.view = view;
+
+    context.data.inv_view = inverse(view);
+    context.data.origin = origin;
+    context.data.prev_view_proj = context.data.view_proj;
+    context.data.view_proj = context.proj * view;
+}
+
+void reproject_accumulation(context_t &context)
+{
+    const auto tiles = tile_count(context);
+    const auto passes = context.data.frame / tiles;
+
+    std::swap(context.accumulation, context.history);
+    std::swap(context.guide, context.history_guide);
+    bind_images(context);
+
+    context.reproject_program.Bind();
+
+    context.data_buffer.Data(
+        &context.data,
+        sizeof(uniform_data_t),
+        GL_STATIC_DRAW);
+
+    const auto groups = (vec2u(context.data.extent.swizzle<0, 1>()) + 7u) / 8u;
+
+    glDispatchCompute(
+        groups[0],
+        groups[1],
+        1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    context.data.prev_view_proj = context.data.view_proj;
+
+    // the tile rotation carries on where it stopped, so a camera that keeps moving still reaches every tile. tiles
+    // before the current one already took sample index passes, and get passes + 1 next, keeping every pixel's sobol
+    // indices distinct without throwing away the partial pass
+    if (passes < context.data.extent[2])
+    {
+        context.data.sample_offset += passes;
+        context.data.frame %= tiles;
+    }
+    else
+    {
+        context.data.sample_offset += context.data.extent[2];
+        context.data.frame = {};
+    }
+
+    // reservoirs are not reprojected; temporal reuse starts over from the new view
+    if (context.restir)
+    {
+        clear_reservoirs(context);
+        context.restir_sample = 0xffffffffu;
+    }
+}
+
+std::uint32_t tile_count(const context_t &context)
+{
+    auto tile_count = (vec2u(context.data.extent.swizzle<0, 1>()) + context.data.tile_extent - 1u)
+                      / context.data.tile_extent;
+    return tile_count[0] * tile_count[1];
+}
+
+bool dispatch_frame(context_t &context)
+{
+    const trace_zone_t zone("dispatch_frame");
+    const gpu_zone_t gpu_zone("dispatch_frame");
+
+    auto sample_index = context.data.frame / tile_count(context);
+
+    if (context.raster_primary && sample_index < context.data.extent[2]
+        && context.gbuffer_sample != context.data.sample_offset + sample_index)
+        draw_gbuffer(context, context.data.sample_offset + sample_index);
+
+    context.data_buffer.Data(
+        &context.data,
+        sizeof(uniform_data_t),
+        GL_STATIC_DRAW);
+
+    if (context.restir && sample_index < context.data.extent[2]
+        && context.restir_sample != context.data.sample_offset + sample_index)
+        resample_direct(context, context.data.sample_offset + sample_index);
+
+    context.compute_program.Bind();
+
+    context.data.frame++;
+
+    if (sample_index >= context.data.extent[2])
+        return false;
+
+    auto groups = (context.data.tile_extent + 7u) / 8u;
+
+    // paths that missed a page finished without accumulating; repeating the dispatch only re-traces those
+    do
+    {
+        glDispatchCompute(
+            groups[0],
+            groups[1],
+            1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    while (context.paged && stream_pages(context));
+
+    return true;
+}
+
+bool write_debug_counters(const context_t &context, const std::filesystem::path &prefix)
+{
+    const auto width = context.data.extent[0];
+    const auto height = context.data.extent[1];
+    const auto pixels = static_cast<std::size_t>(width) * height;
+
+    std::vector<float> counters(pixels * 4);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    context.debug_buffer.GetSubData(0, counters.data(), counters.size() * sizeof(float));
+
+    constexpr const char *names[]{ "nodes", "triangles", "shadow_rays", "path_length" };
+
+    // the buffer is already in pfm row order, bottom to top
+    for (std::size_t channel = 0; channel < std::size(names); ++channel)
+    {
+        image_t image{ .width = width, .height = height, .channels = 1 };
+        image.pixels.resize(pixels);
+
+        for (std::size_t i = 0; i < pixels; ++i)
+            image.pixels[i] = counters[i * 4 + channel];
+
+        auto path = prefix;
+        path += std::string("_") + names[channel] + ".pfm";
+
+        if (!write_pfm(path, image))
+            return false;
+    }
+
+    return true;
+}
+
+// each counter has its own useful range; traversal counts span orders of magnitude, paths at most max_bounces
+static float debug_scale(const context_t &context)
+{
+    switch (context.debug_view)
+    {
+    case DEBUG_VIEW_NODES:
+        return 1024.0f;
+    case DEBUG_VIEW_TRIANGLES:
+        return 256.0f;
+    // light and environment next-event estimation can each cast one per bounce
+    case DEBUG_VIEW_SHADOW_RAYS:
+        return static_cast<float>(2 * context.max_bounces);
+    default:
+        return static_cast<float>(context.max_bounces);
+    }
+}
+
+void draw_accumulation(const context_t &context)
+{
+    const gpu_zone_t gpu_zone("draw_accumulation");
+
+    // the heatmap reads the counters straight from the buffer the trace pass wrote
+    if (context.debug_view != DEBUG_VIEW_COLOR)
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    context.draw_program.Uniform(0, static_cast<GLuint>(context.debug_view));
+    context.draw_program.Uniform(1, debug_scale(context));
+
+    context.vertex_array.Bind();
+    context.draw_program.Bind();
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
@@ -0,0 +1,547 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <glrt/distributed.hxx>
+#include <glrt/image.hxx>
+
+static constexpr std::uint32_t PROTOCOL_MAGIC = 0x54524c47u; // "GLRT"
+static constexpr std::uint32_t UNIT_QUIT = 0xffffffffu;
+static constexpr std::size_t UNITS_IN_FLIGHT = 2;
+
+struct setup_message_t
+{
+    std::uint32_t magic;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t samples;
+    std::uint32_t tile_width;
+    std::uint32_t tile_height;
+};
+
+struct unit_message_t
+{
+    std::uint32_t tile;
+    std::uint32_t sample_begin;
+    std::uint32_t sample_end;
+};
+
+struct result_message_t
+{
+    std::uint32_t tile;
+    std::uint32_t sample_begin;
+    std::uint32_t sample_end;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t _0;
+    std::uint64_t elapsed_ns;
+};
+
+struct worker_t
+{
+    int fd;
+    std::deque<unit_message_t> pending;
+    std::uint64_t busy_ns{};
+    std::uint64_t samples{};
+    std::uint32_t units{};
+};
+
+static bool send_all(const int fd, const void *data, std::size_t length)
+{
+    auto bytes = static_cast<const char *>(data);
+    while (length)
+    {
+        const auto n = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        bytes += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool recv_all(const int fd, void *data, std::size_t length)
+{
+    auto bytes = static_cast<char *>(data);
+    while (length)
+    {
+        const auto n = recv(fd, bytes, length, 0);
+        if (n <= 0)
+            return false;
+        bytes += n;
+        length -= n;
+    }
+    return true;
+}
+
+static void split_address(const std::string &address, std::string &host, std::string &port)
+{
+    if (const auto colon = address.rfind(':'); colon != std::string::npos)
+    {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+    else
+    {
+        host.clear();
+        port = address;
+    }
+}
+
+static int connect_to(const std::string &address)
+{
+    std::string host, port;
+    split_address(address, host, port);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *result;
+    if (getaddrinfo(host.empty() ? "127.0.0.1" : host.c_str(), port.c_str(), &hints, &result))
+        return -1;
+
+    auto fd = -1;
+    for (auto info = result; info; info = info->ai_next)
+    {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (!connect(fd, info->ai_addr, info->ai_addrlen))
+            break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+
+    if (fd >= 0)
+    {
+        constexpr int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+static int listen_on(const std::string &address, std::uint16_t &port)
+{
+    std::string host, service;
+    split_address(address, host, service);
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo *result;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result))
+        return -1;
+
+    const auto fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (fd >= 0)
+    {
+        constexpr int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        if (bind(fd, result->ai_addr, result->ai_addrlen) || listen(fd, 16))
+        {
+            close(fd);
+            freeaddrinfo(result);
+            return -1;
+        }
+    }
+    freeaddrinfo(result);
+
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&bound), &length);
+    port = ntohs(bound.sin_port);
+
+    return fd;
+}
+
+static pid_t spawn_worker(const std::uint16_t port, const options_t &options)
+{
+    const auto pid = fork();
+    if (pid)
+        return pid;
+
+    const auto address = "127.0.0.1:" + std::to_string(port);
+    const auto threads = std::to_string(options.threads);
+    std::vector<const char *> args{ "glrt", "--worker", address.c_str() };
+    if (!options.scene.empty())
+        args.insert(args.end(), { "--scene", options.scene.c_str() });
+    if (!options.environment.empty())
+        args.insert(args.end(), { "--environment", options.environment.c_str() });
+    if (options.threads)
+        args.insert(args.end(), { "--threads", threads.c_str() });
+    args.push_back(nullptr);
+
+    execv("/proc/self/exe", const_cast<char *const *>(args.data()));
+    _exit(127);
+}
+
+static bool send_unit(worker_t &worker, std::deque<unit_message_t> &queue)
+{
+    const auto unit = queue.front();
+    if (!send_all(worker.fd, &unit, sizeof(unit)))
+        return false;
+
+    queue.pop_front();
+    worker.pending.push_back(unit);
+    return true;
+}
+
+// its units go back to the front of the queue; the worker is erased at the end of the poll iteration
+static void drop_worker(worker_t &worker, const std::size_t index, std::deque<unit_message_t> &queue)
+{
+    std::cerr << "lost worker " << index << ", requeueing " << worker.pending.size() << " units" << std::endl;
+    for (auto &unit : worker.pending)
+        queue.push_front(unit);
+    worker.pending.clear();
+    close(worker.fd);
+    worker.fd = -1;
+}
+
+// returns false if any worker was dropped, since its units went back to a queue the others may already have passed
+static bool top_up_workers(std::vector<worker_t> &workers, std::deque<unit_message_t> &queue)
+{
+    auto stable = true;
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        auto &worker = workers[i];
+        while (worker.fd >= 0 && worker.pending.size() < UNITS_IN_FLIGHT && !queue.empty())
+            if (!send_unit(worker, queue))
+            {
+                drop_worker(worker, i, queue);
+                stable = false;
+            }
+    }
+    return stable;
+}
+
+// a result has to answer the oldest unit sent to its worker and carry exactly that tile's clipped extent; anything
+// else would add pixels outside the tile, or outside the image
+static bool valid_result(const result_message_t &result, const unit_message_t &unit, const setup_message_t &setup)
+{
+    const auto tiles_x = (setup.width + setup.tile_width - 1) / setup.tile_width;
+    const auto tiles_y = (setup.height + setup.tile_height - 1) / setup.tile_height;
+
+    if (result.tile != unit.tile || result.sample_begin != unit.sample_begin || result.sample_end != unit.sample_end
+        || result.tile >= tiles_x * tiles_y)
+        return false;
+
+    const auto x = (result.tile % tiles_x) * setup.tile_width;
+    const auto y = (result.tile / tiles_x) * setup.tile_height;
+    return result.width == std::min(setup.tile_width, setup.width - x)
+           && result.height == std::min(setup.tile_height, setup.height - y);
+}
+
+int run_coordinator(const options_t &options, const vec2u &tile_extent)
+{
+    std::uint16_t port;
+    const auto listen_fd = listen_on(options.address, port);
+    if (listen_fd < 0)
+    {
+        std::cerr << "failed to listen on " << options.address << std::endl;
+        return 1;
+    }
+
+    std::cerr << "coordinator listening on port " << port << std::endl;
+
+    std::vector<pid_t> children;
+    for (std::uint32_t i = 0; i < options.local_workers; ++i)
+        if (const auto pid = spawn_worker(port, options); pid > 0)
+            children.push_back(pid);
+
+    const setup_message_t setup
+    {
+        .magic = PROTOCOL_MAGIC,
+        .width = options.width,
+        .height = options.height,
+        .samples = options.samples,
+        .tile_width = tile_extent[0],
+        .tile_height = tile_extent[1],
+    };
+
+    const auto tiles_x = (options.width + tile_extent[0] - 1) / tile_extent[0];
+    const auto tiles_y = (options.height + tile_extent[1] - 1) / tile_extent[1];
+
+    std::deque<unit_message_t> queue;
+    for (std::uint32_t s = 0; s < options.samples; s += options.unit_samples)
+        for (std::uint32_t tile = 0; tile < tiles_x * tiles_y; ++tile)
+            queue.push_back(
+                {
+                    .tile = tile,
+                    .sample_begin = s,
+                    .sample_end = std::min(s + options.unit_samples, options.samples),
+                });
+
+    const auto unit_count = queue.size();
+    std::size_t completed = 0;
+
+    // workers lost before everyone connected are not waited for
+    auto expected_workers = options.workers + options.local_workers;
+
+    image_t image
+    {
+        .width = options.width,
+        .height = options.height,
+    };
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 3);
+
+    std::vector<worker_t> workers;
+    std::vector<float> tile_pixels;
+
+    std::chrono::steady_clock::time_point start;
+    auto started = false;
+
+    while (completed < unit_count)
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({ listen_fd, POLLIN, 0 });
+        for (auto &worker : workers)
+            fds.push_back({ worker.fd, POLLIN, 0 });
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+            break;
+
+        if (fds[0].revents & POLLIN)
+        {
+            if (const auto fd = accept(listen_fd, nullptr, nullptr); fd >= 0)
+            {
+                constexpr int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+                if (send_all(fd, &setup, sizeof(setup)))
+                    workers.push_back({ .fd = fd });
+                else
+                    close(fd);
+
+            }
+        }
+
+        for (std::size_t i = 1; i < fds.size(); ++i)
+        {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            auto &worker = workers[i - 1];
+
+            result_message_t result;
+            auto ok = recv_all(worker.fd, &result, sizeof(result)) && !worker.pending.empty()
+                      && valid_result(result, worker.pending.front(), setup);
+            if (ok)
+            {
+                tile_pixels.resize(static_cast<std::size_t>(result.width) * result.height * 3);
+                ok = recv_all(worker.fd, tile_pixels.data(), tile_pixels.size() * sizeof(float));
+            }
+
+            if (!ok)
+            {
+                drop_worker(worker, i - 1, queue);
+                if (!started)
+                    --expected_workers;
+                continue;
+            }
+
+            const auto x0 = (result.tile % tiles_x) * tile_extent[0];
+            const auto y0 = (result.tile / tiles_x) * tile_extent[1];
+            for (std::uint32_t y = 0; y < result.height; ++y)
+                for (std::uint32_t x = 0; x < result.width; ++x)
+                    for (std::uint32_t c = 0; c < 3; ++c)
+                        image.pixels[((y0 + y) * image.width + x0 + x) * 3 + c]
+                                += tile_pixels[(y * result.width + x) * 3 + c];
+
+            worker.pending.pop_front();
+            worker.busy_ns += result.elapsed_ns;
+            worker.samples += static_cast<std::uint64_t>(result.sample_end - result.sample_begin)
+                    * result.width * result.height;
+            worker.units++;
+            completed++;
+        }
+
+        if (!started && !workers.empty() && workers.size() >= expected_workers)
+        {
+            start = std::chrono::steady_clock::now();
+            started = true;
+        }
+
+        // every live worker, not only the ones that just returned a result: units requeued from a lost worker would
+        // otherwise wait for a result that idle workers never send, and poll would block forever
+        if (started)
+            while (!top_up_workers(workers, queue))
+                ;
+
+        std::erase_if(
+            workers,
+            [](const worker_t &worker)
+            {
+                return worker.fd < 0;
+            });
+
+        if ((started || !expected_workers) && workers.empty())
+        {
+            std::cerr << "no workers left" << std::endl;
+            break;
+        }
+    }
+
+    const auto wall = started ? std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() : 0.0;
+
+    for (auto &worker : workers)
+    {
+        constexpr unit_message_t quit{ .tile = UNIT_QUIT };
+        send_all(worker.fd, &quit, sizeof(quit));
+        close(worker.fd);
+    }
+    close(listen_fd);
+
+    for (const auto pid : children)
+        waitpid(pid, nullptr, 0);
+
+    if (completed < unit_count)
+    {
+        std::cerr << "rendering incomplete: " << completed << " of " << unit_count << " units" << std::endl;
+        return 1;
+    }
+
+    for (auto &value : image.pixels)
+        value /= static_cast<float>(options.samples);
+
+    if (!write_pfm(options.output, image))
+    {
+        std::cerr << "failed to write " << options.output << std::endl;
+        return 1;
+    }
+
+    double busy{};
+    std::uint64_t samples{};
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        busy += static_cast<double>(workers[i].busy_ns) * 1e-9;
+        samples += workers[i].samples;
+
+        std::cerr << "worker " << i << ": "
+                << workers[i].units << " units, "
+                << std::fixed << std::setprecision(2) << static_cast<double>(workers[i].busy_ns) * 1e-9 << " s busy, "
+                << std::setprecision(4)
+                << (workers[i].busy_ns
+                        ? static_cast<double>(workers[i].samples) / (static_cast<double>(workers[i].busy_ns) * 1e-3)
+                        : 0.0)
+                << " Msamples/s" << std::endl;
+    }
+
+    // utilization is busy over wall time; workers sharing one gpu stay busy while slowing each other down, so
+    // scaling is T1 / (N * TN) over the wall times of runs with one and N workers
+    std::cerr << std::fixed << std::setprecision(2)
+            << "wall " << wall << " s, "
+            << std::setprecision(4) << static_cast<double>(samples) / wall * 1e-6 << " Msamples/s, "
+            << std::setprecision(2)
+            << "utilization " << (workers.empty() ? 0.0 : busy / (wall * workers.size()) * 100.0) << " %"
+            << std::endl;
+
+    return 0;
+}
+
+int run_worker(const options_t &options, context_t &context)
+{
+    const auto fd = connect_to(options.address);
+    if (fd < 0)
+    {
+        std::cerr << "failed to connect to " << options.address << std::endl;
+        return 1;
+    }
+
+    setup_message_t setup;
+    if (!recv_all(fd, &setup, sizeof(setup)) || setup.magic != PROTOCOL_MAGIC)
+    {
+        std::cerr << "invalid coordinator handshake" << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    context.data.extent[2] = setup.samples;
+    context.data.tile_extent = { setup.tile_width, setup.tile_height };
+    resize_accumulation(context, setup.width, setup.height);
+
+    const auto tiles = tile_count(context);
+    const auto tiles_x = (setup.width + setup.tile_width - 1) / setup.tile_width;
+
+    std::vector<float> rgba;
+    std::vector<float> rgb;
+
+    for (unit_message_t unit; recv_all(fd, &unit, sizeof(unit)) && unit.tile != UNIT_QUIT;)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (auto s = unit.sample_begin; s < unit.sample_end; ++s)
+        {
+            context.data.frame = s * tiles + unit.tile;
+            dispatch_frame(context);
+        }
+
+        const auto x = (unit.tile % tiles_x) * setup.tile_width;
+        const auto y = (unit.tile / tiles_x) * setup.tile_height;
+        const auto width = std::min(setup.tile_width, setup.width - x);
+        const auto height = std::min(setup.tile_height, setup.height - y);
+
+        rgba.resize(static_cast<std::size_t>(width) * height * 4);
+        rgb.resize(static_cast<std::size_t>(width) * height * 3);
+
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        context.accumulation.GetSubImage(
+            0,
+            static_cast<GLint>(x),
+            static_cast<GLint>(y),
+            static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height),
+            GL_RGBA,
+            GL_FLOAT,
+            static_cast<GLsizei>(rgba.size() * sizeof(float)),
+            rgba.data());
+
+        constexpr float zero[4]{};
+        context.accumulation.ClearSubImage(
+            0,
+            static_cast<GLint>(x),
+            static_cast<GLint>(y),
+            static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height),
+            GL_RGBA,
+            GL_FLOAT,
+            zero);
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(width) * height; ++i)
+            for (std::size_t c = 0; c < 3; ++c)
+                rgb[i * 3 + c] = rgba[i * 4 + c];
+
+        const result_message_t result
+        {
+            .tile = unit.tile,
+            .sample_begin = unit.sample_begin,
+            .sample_end = unit.sample_end,
+            .width = width,
+            .height = height,
+            .elapsed_ns = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count()),
+        };
+
+        if (!send_all(fd, &result, sizeof(result)) || !send_all(fd, rgb.data(), rgb.size() * sizeof(float)))
+            break;
+    }
+
+    close(fd);
+    return 0;
+}
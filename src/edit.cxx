@@ -0,0 +1,785 @@
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <queue>
+#include <glrt/edit.hxx>
+#include <glrt/kernel.hxx>
+#include <glrt/trace.hxx>
+
+static constexpr auto IDENTITY = identity<4, float>();
+
+// a point far outside any scene; the root of an empty tree is never entered
+static constexpr float EMPTY_FAR = 1e30f;
+
+// slack reserved up front, so the first edits append without moving whole arrays
+static constexpr std::size_t EDIT_HEADROOM_MIN = 4096;
+
+template<typename T>
+static void reserve_headroom(std::vector<T> &data)
+{
+    data.reserve(data.size() + std::max(data.size() / 8, EDIT_HEADROOM_MIN));
+}
+
+void dirty_ranges_t::mark(const std::size_t begin, const std::size_t end)
+{
+    if (begin < end)
+        m_Ranges.emplace_back(begin, end);
+}
+
+void dirty_ranges_t::mark(const std::size_t index)
+{
+    mark(index, index + 1);
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> dirty_ranges_t::ranges(const std::size_t gap) const
+{
+    auto sorted = m_Ranges;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<std::pair<std::size_t, std::size_t>> merged;
+    for (auto &range : sorted)
+    {
+        if (!merged.empty() && range.first <= merged.back().second + gap)
+            merged.back().second = std::max(merged.back().second, range.second);
+        else
+            merged.push_back(range);
+    }
+
+    return merged;
+}
+
+bool dirty_ranges_t::empty() const
+{
+    return m_Ranges.empty();
+}
+
+void dirty_ranges_t::clear()
+{
+    m_Ranges.clear();
+}
+
+static bool is_leaf(const bvh_node_t &node)
+{
+    return node.begin != node.end;
+}
+
+static box_t node_box(const bvh_node_t &node)
+{
+    return { node.box_min, node.box_max };
+}
+
+static bvh_node_t inner_node(const box_t &bounds, const std::uint32_t left, const std::uint32_t right)
+{
+    return {
+        .box_min = bounds.min,
+        .box_max = bounds.max,
+        .left = left,
+        .right = right,
+        .begin = 0xffffffffu,
+        .end = 0xffffffffu,
+    };
+}
+
+static bvh_node_t empty_root()
+{
+    return inner_node({ { EMPTY_FAR, EMPTY_FAR, EMPTY_FAR }, { EMPTY_FAR, EMPTY_FAR, EMPTY_FAR } }, 0, 0);
+}
+
+// nodes above the object subtrees; the only ones edits relink or rotate
+static bool is_top_level(const editable_scene_t &scene, const std::uint32_t node)
+{
+    return scene.owners[node] == EDIT_NONE && !is_leaf(scene.bvh.nodes[node]);
+}
+
+static std::uint32_t allocate_range(std::vector<edit_range_t> &free_ranges, const std::uint32_t count, const std::size_t end)
+{
+    for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it)
+    {
+        if (it->count < count)
+            continue;
+
+        const auto begin = it->begin;
+        it->begin += count;
+        if (!(it->count -= count))
+            free_ranges.erase(it);
+        return begin;
+    }
+
+    return static_cast<std::uint32_t>(end);
+}
+
+// kept sorted and merged with its neighbours, so fragmentation stays bounded by the live objects
+static void free_range(std::vector<edit_range_t> &free_ranges, const edit_range_t range)
+{
+    if (!range.count)
+        return;
+
+    auto it = std::lower_bound(
+        free_ranges.begin(),
+        free_ranges.end(),
+        range.begin,
+        [](const edit_range_t &r, const std::uint32_t begin)
+        {
+            return r.begin < begin;
+        });
+    it = free_ranges.insert(it, range);
+
+    if (auto next = it + 1; next != free_ranges.end() && it->begin + it->count == next->begin)
+    {
+        it->count += next->count;
+        free_ranges.erase(next);
+    }
+
+    if (it != free_ranges.begin())
+    {
+        if (auto prev = it - 1; prev->begin + prev->count == it->begin)
+        {
+            prev->count += it->count;
+            free_ranges.erase(it);
+        }
+    }
+}
+
+static std::uint32_t allocate_node(editable_scene_t &scene)
+{
+    if (!scene.free_nodes.empty())
+    {
+        const auto node = scene.free_nodes.back();
+        scene.free_nodes.pop_back();
+        return node;
+    }
+
+    scene.bvh.nodes.emplace_back();
+    scene.parents.push_back(EDIT_NONE);
+    scene.owners.push_back(EDIT_NONE);
+    return static_cast<std::uint32_t>(scene.bvh.nodes.size() - 1);
+}
+
+static void set_child(editable_scene_t &scene, const std::uint32_t parent, const std::uint32_t from, const std::uint32_t to)
+{
+    auto &node = scene.bvh.nodes[parent];
+    (node.left == from ? node.left : node.right) = to;
+    scene.parents[to] = parent;
+    scene.dirty_nodes.mark(parent);
+}
+
+// copies a node into another slot and repoints its children and its object; the caller links the new slot in
+static void move_node(editable_scene_t &scene, const std::uint32_t from, const std::uint32_t to)
+{
+    auto &nodes = scene.bvh.nodes;
+
+    nodes[to] = nodes[from];
+    scene.owners[to] = scene.owners[from];
+
+    if (!is_leaf(nodes[to]))
+    {
+        scene.parents[nodes[to].left] = to;
+        scene.parents[nodes[to].right] = to;
+    }
+
+    if (const auto owner = scene.owners[to]; owner != EDIT_NONE && scene.objects[owner].root == from)
+        scene.objects[owner].root = to;
+
+    scene.dirty_nodes.mark(to);
+}
+
+// tree rotation of kopta et al.: swaps a child with a grandchild on the other side when that shrinks the inner
+// child's box, which is the only box that changes
+static void rotate(editable_scene_t &scene, const std::uint32_t node)
+{
+    auto &nodes = scene.bvh.nodes;
+
+    auto best_gain = 0.0f;
+    std::uint32_t best_inner = EDIT_NONE, best_grandchild{}, best_other{};
+
+    for (const auto &[inner, other] : { std::pair{ nodes[node].left, nodes[node].right },
+                                       std::pair{ nodes[node].right, nodes[node].left } })
+    {
+        if (!is_top_level(scene, inner))
+            continue;
+
+        const auto inner_area = box_area(node_box(nodes[inner]));
+        for (const auto &[grandchild, kept] : { std::pair{ nodes[inner].left, nodes[inner].right },
+                                               std::pair{ nodes[inner].right, nodes[inner].left } })
+        {
+            const auto gain = inner_area - box_area(box_union(node_box(nodes[other]), node_box(nodes[kept])));
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best_inner = inner;
+                best_grandchild = grandchild;
+                best_other = other;
+            }
+        }
+    }
+
+    if (best_inner == EDIT_NONE)
+        return;
+
+    set_child(scene, node, best_other, best_grandchild);
+    set_child(scene, best_inner, best_grandchild, best_other);
+
+    auto &inner = nodes[best_inner];
+    const auto bounds = box_union(node_box(nodes[inner.left]), node_box(nodes[inner.right]));
+    inner.box_min = bounds.min;
+    inner.box_max = bounds.max;
+}
+
+// refits and rotates every top-level node from node up to the root
+static void refit_from(editable_scene_t &scene, std::uint32_t node)
+{
+    auto &nodes = scene.bvh.nodes;
+
+    for (; node != EDIT_NONE; node = scene.parents[node])
+    {
+        rotate(scene, node);
+
+        const auto bounds = box_union(node_box(nodes[nodes[node].left]), node_box(nodes[nodes[node].right]));
+        nodes[node].box_min = bounds.min;
+        nodes[node].box_max = bounds.max;
+        scene.dirty_nodes.mark(node);
+    }
+}
+
+// branch and bound over the top level for the sibling that adds the least surface area (bittner et al.)
+static std::uint32_t find_sibling(const editable_scene_t &scene, const box_t &bounds)
+{
+    struct candidate_t
+    {
+        float inherited;
+        std::uint32_t node;
+
+        bool operator<(const candidate_t &other) const
+        {
+            return inherited > other.inherited;
+        }
+    };
+
+    const auto &nodes = scene.bvh.nodes;
+    const auto area = box_area(bounds);
+
+    std::uint32_t best = 0;
+    auto best_cost = box_area(box_union(node_box(nodes[0]), bounds));
+
+    std::priority_queue<candidate_t> queue;
+    queue.push({ 0.0f, 0 });
+
+    while (!queue.empty())
+    {
+        const auto [inherited, node] = queue.top();
+        queue.pop();
+
+        if (inherited + area >= best_cost)
+            break;
+
+        const auto node_area = box_area(node_box(nodes[node]));
+        const auto direct = box_area(box_union(node_box(nodes[node]), bounds));
+
+        if (inherited + direct < best_cost)
+        {
+            best_cost = inherited + direct;
+            best = node;
+        }
+
+        if (!is_top_level(scene, node))
+            continue;
+
+        if (const auto child_inherited = inherited + direct - node_area; child_inherited + area < best_cost)
+        {
+            queue.push({ child_inherited, nodes[node].left });
+            queue.push({ child_inherited, nodes[node].right });
+        }
+    }
+
+    return best;
+}
+
+static void link_root(editable_scene_t &scene, const std::uint32_t root)
+{
+    auto &nodes = scene.bvh.nodes;
+
+    // traversal always starts at node 0, so whatever becomes the root moves there
+    if (scene.empty)
+    {
+        move_node(scene, root, 0);
+        scene.parents[0] = EDIT_NONE;
+        scene.free_nodes.push_back(root);
+        scene.empty = false;
+        return;
+    }
+
+    const auto bounds = node_box(nodes[root]);
+    const auto sibling = find_sibling(scene, bounds);
+
+    if (sibling == 0)
+    {
+        const auto moved = allocate_node(scene);
+        move_node(scene, 0, moved);
+
+        nodes[0] = inner_node(box_union(node_box(nodes[moved]), bounds), moved, root);
+        scene.owners[0] = EDIT_NONE;
+        scene.parents[moved] = 0;
+        scene.parents[root] = 0;
+        refit_from(scene, 0);
+        return;
+    }
+
+    const auto parent = scene.parents[sibling];
+    const auto node = allocate_node(scene);
+
+    nodes[node] = inner_node(box_union(node_box(nodes[sibling]), bounds), sibling, root);
+    scene.owners[node] = EDIT_NONE;
+    set_child(scene, parent, sibling, node);
+    scene.parents[sibling] = node;
+    scene.parents[root] = node;
+    refit_from(scene, node);
+}
+
+static void unlink_root(editable_scene_t &scene, const std::uint32_t root)
+{
+    auto &nodes = scene.bvh.nodes;
+
+    const auto parent = scene.parents[root];
+    if (parent == EDIT_NONE)
+    {
+        nodes[0] = empty_root();
+        scene.owners[0] = EDIT_NONE;
+        scene.dirty_nodes.mark(0);
+        scene.empty = true;
+        return;
+    }
+
+    const auto sibling = nodes[parent].left == root ? nodes[parent].right : nodes[parent].left;
+
+    if (const auto grandparent = scene.parents[parent]; grandparent != EDIT_NONE)
+    {
+        set_child(scene, grandparent, parent, sibling);
+        scene.free_nodes.push_back(parent);
+        refit_from(scene, grandparent);
+        return;
+    }
+
+    // the parent is the root: the sibling takes over slot 0
+    move_node(scene, sibling, 0);
+    scene.parents[0] = EDIT_NONE;
+    scene.free_nodes.push_back(sibling);
+}
+
+static void add_light(editable_scene_t &scene, const std::uint32_t base, const float area)
+{
+    if (area <= 0.0f)
+        return;
+
+    auto &bvh = scene.bvh;
+
+    std::uint32_t slot;
+    if (!scene.free_lights.empty())
+    {
+        slot = scene.free_lights.back();
+        scene.free_lights.pop_back();
+    }
+    else
+    {
+        slot = static_cast<std::uint32_t>(bvh.lights.size());
+        bvh.lights.emplace_back();
+        bvh.light_areas.emplace_back();
+    }
+
+    bvh.lights[slot] = base;
+    bvh.light_areas[slot] = area;
+    scene.light_slots.emplace(base, slot);
+    scene.dirty_lights.mark(slot);
+
+    scene.light_area_sum += area;
+    bvh.total_light_area = static_cast<float>(scene.light_area_sum);
+}
+
+static void remove_light(editable_scene_t &scene, const std::uint32_t base)
+{
+    const auto it = scene.light_slots.find(base);
+    if (it == scene.light_slots.end())
+        return;
+
+    auto &bvh = scene.bvh;
+    const auto slot = it->second;
+
+    scene.light_area_sum -= bvh.light_areas[slot];
+    if (scene.light_slots.size() == 1)
+        scene.light_area_sum = 0.0;
+    bvh.total_light_area = static_cast<float>(scene.light_area_sum);
+
+    // sample_light walks the areas by cumulative sum; a zero entry is never picked
+    bvh.lights[slot] = 0;
+    bvh.light_areas[slot] = 0.0f;
+    scene.dirty_lights.mark(slot);
+
+    scene.free_lights.push_back(slot);
+    scene.light_slots.erase(it);
+}
+
+static float emitting_area(const editable_scene_t &scene, const std::uint32_t base)
+{
+    const auto &model = scene.model;
+    const auto &v0 = model.vertices[model.indices[base + 0]];
+
+    if (!model.materials[v0.material].is_emissive())
+        return 0.0f;
+
+    return triangle_area(
+        v0.position,
+        model.vertices[model.indices[base + 1]].position,
+        model.vertices[model.indices[base + 2]].position);
+}
+
+void make_editable(model_t &&model, bvh_t &&bvh, editable_scene_t &scene)
+{
+    scene = {};
+    scene.model = std::move(model);
+    scene.bvh = std::move(bvh);
+
+    auto &nodes = scene.bvh.nodes;
+
+    if (scene.model.indices.empty() || nodes.empty())
+    {
+        nodes.assign(1, empty_root());
+        scene.parents.assign(1, EDIT_NONE);
+        scene.owners.assign(1, EDIT_NONE);
+        scene.empty = true;
+        return;
+    }
+
+    scene.parents.assign(nodes.size(), EDIT_NONE);
+    scene.owners.assign(nodes.size(), 0);
+
+    for (std::uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        if (is_leaf(nodes[i]))
+            continue;
+
+        scene.parents[nodes[i].left] = i;
+        scene.parents[nodes[i].right] = i;
+    }
+
+    scene.objects.push_back(
+        {
+            .vertices = { 0, static_cast<std::uint32_t>(scene.model.vertices.size()) },
+            .indices = { 0, static_cast<std::uint32_t>(scene.model.indices.size()) },
+            .map = { 0, static_cast<std::uint32_t>(scene.bvh.map.size()) },
+            .root = 0,
+            .alive = true,
+        });
+
+    for (std::uint32_t i = 0; i < scene.bvh.lights.size(); ++i)
+    {
+        scene.light_slots.emplace(scene.bvh.lights[i], i);
+        scene.light_area_sum += scene.bvh.light_areas[i];
+    }
+
+    reserve_headroom(scene.model.indices);
+    reserve_headroom(scene.model.vertices);
+    reserve_headroom(scene.bvh.nodes);
+    reserve_headroom(scene.bvh.map);
+    reserve_headroom(scene.bvh.lights);
+    reserve_headroom(scene.bvh.light_areas);
+    reserve_headroom(scene.parents);
+    reserve_headroom(scene.owners);
+}
+
+static void insert_object(editable_scene_t &scene, const std::uint32_t id, const model_t &mesh, const mat4f &transform)
+{
+    auto &model = scene.model;
+    auto &bvh = scene.bvh;
+
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+
+    std::pmr::vector<std::uint32_t> remap(&arena);
+    const auto material_count = model.materials.size();
+    model.merge_materials(mesh, remap);
+    scene.dirty_materials.mark(material_count, model.materials.size());
+
+    auto &object = scene.objects[id];
+    object = { .alive = true };
+
+    const auto vertex_count = static_cast<std::uint32_t>(mesh.vertices.size());
+    const auto first_vertex = allocate_range(scene.free_vertices, vertex_count, model.vertices.size());
+    object.vertices = { first_vertex, vertex_count };
+
+    model.vertices.resize(std::max<std::size_t>(model.vertices.size(), first_vertex + vertex_count));
+    std::copy(mesh.vertices.begin(), mesh.vertices.end(), model.vertices.begin() + first_vertex);
+
+    for (auto v = model.vertices.begin() + first_vertex; v != model.vertices.begin() + first_vertex + vertex_count; ++v)
+        if (v->material < remap.size())
+            v->material = remap[v->material];
+
+    if (transform != IDENTITY)
+        transform_vertices(transform, model.vertices.data() + first_vertex, vertex_count);
+
+    scene.dirty_vertices.mark(first_vertex, first_vertex + vertex_count);
+
+    const auto index_count = static_cast<std::uint32_t>(mesh.indices.size() / 3 * 3);
+    const auto first_index = allocate_range(scene.free_indices, index_count, model.indices.size());
+    object.indices = { first_index, index_count };
+
+    model.indices.resize(std::max<std::size_t>(model.indices.size(), first_index + index_count));
+    for (std::uint32_t i = 0; i < index_count; ++i)
+        model.indices[first_index + i] = mesh.indices[i] + first_vertex;
+
+    scene.dirty_indices.mark(first_index, first_index + index_count);
+
+    const auto triangle_count = index_count / 3;
+    if (!triangle_count)
+        return;
+
+    std::vector<triangle_t> triangles(triangle_count);
+    for (std::uint32_t t = 0; t < triangle_count; ++t)
+    {
+        const auto base = first_index + t * 3;
+
+        auto &p0 = model.vertices[model.indices[base + 0]].position;
+        auto &p1 = model.vertices[model.indices[base + 1]].position;
+        auto &p2 = model.vertices[model.indices[base + 2]].position;
+
+        triangles[t] = {
+            .index = base,
+            .bounds = { min(p0, min(p1, p2)), max(p0, max(p1, p2)) },
+            .centroid = (p0 + p1 + p2) / 3.0f,
+        };
+
+        add_light(scene, base, emitting_area(scene, base));
+    }
+
+    // the object's subtree is built off to the side, then scattered into free node slots
+    std::vector<bvh_node_t> nodes;
+    nodes.reserve(triangle_count * 2);
+    build_bvh_node(nodes, triangles, 0, triangle_count);
+
+    const auto first_map = allocate_range(scene.free_map, triangle_count, bvh.map.size());
+    object.map = { first_map, triangle_count };
+
+    bvh.map.resize(std::max<std::size_t>(bvh.map.size(), first_map + triangle_count));
+    for (std::uint32_t i = 0; i < triangle_count; ++i)
+        bvh.map[first_map + i] = triangles[i].index;
+
+    scene.dirty_map.mark(first_map, first_map + triangle_count);
+
+    std::vector<std::uint32_t> slots(nodes.size());
+    for (auto &slot : slots)
+        slot = allocate_node(scene);
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto node = nodes[i];
+        const auto slot = slots[i];
+
+        if (is_leaf(node))
+        {
+            node.begin += first_map;
+            node.end += first_map;
+        }
+        else
+        {
+            node.left = slots[node.left];
+            node.right = slots[node.right];
+            scene.parents[node.left] = slot;
+            scene.parents[node.right] = slot;
+        }
+
+        bvh.nodes[slot] = node;
+        scene.owners[slot] = id;
+        scene.dirty_nodes.mark(slot);
+    }
+
+    object.root = slots[0];
+    scene.parents[object.root] = EDIT_NONE;
+
+    link_root(scene, object.root);
+}
+
+static void release_object(editable_scene_t &scene, const std::uint32_t id)
+{
+    auto &object = scene.objects[id];
+    auto &model = scene.model;
+
+    for (auto base = object.indices.begin; base < object.indices.begin + object.indices.count; base += 3)
+        remove_light(scene, base);
+
+    // freed triangles collapse onto one vertex, so the raster g-buffer pass draws nothing for them
+    std::fill_n(model.indices.begin() + object.indices.begin, object.indices.count, 0u);
+    scene.dirty_indices.mark(object.indices.begin, object.indices.begin + object.indices.count);
+
+    free_range(scene.free_vertices, object.vertices);
+    free_range(scene.free_indices, object.indices);
+    free_range(scene.free_map, object.map);
+
+    if (object.root != EDIT_NONE)
+    {
+        std::vector<std::uint32_t> subtree{ object.root };
+        for (std::size_t i = 0; i < subtree.size(); ++i)
+            if (const auto &node = scene.bvh.nodes[subtree[i]]; !is_leaf(node))
+                subtree.insert(subtree.end(), { node.left, node.right });
+
+        unlink_root(scene, object.root);
+
+        for (const auto node : subtree)
+            if (node != 0)
+                scene.free_nodes.push_back(node);
+    }
+
+    object = {};
+}
+
+std::uint32_t insert_mesh(editable_scene_t &scene, const model_t &mesh, const mat4f &transform)
+{
+    const trace_zone_t zone("insert_mesh");
+
+    std::uint32_t id;
+    if (!scene.free_objects.empty())
+    {
+        id = scene.free_objects.back();
+        scene.free_objects.pop_back();
+    }
+    else
+    {
+        id = static_cast<std::uint32_t>(scene.objects.size());
+        scene.objects.emplace_back();
+    }
+
+    insert_object(scene, id, mesh, transform);
+    return id;
+}
+
+void remove_mesh(editable_scene_t &scene, const std::uint32_t object)
+{
+    const trace_zone_t zone("remove_mesh");
+
+    if (object >= scene.objects.size() || !scene.objects[object].alive)
+        return;
+
+    release_object(scene, object);
+    scene.free_objects.push_back(object);
+}
+
+void replace_mesh(editable_scene_t &scene, const std::uint32_t object, const model_t &mesh, const mat4f &transform)
+{
+    const trace_zone_t zone("replace_mesh");
+
+    if (object >= scene.objects.size())
+        return;
+
+    if (scene.objects[object].alive)
+        release_object(scene, object);
+
+    insert_object(scene, object, mesh, transform);
+}
+
+// emissive triangles of the material join or leave the light list
+static void relight_material(editable_scene_t &scene, const std::uint32_t material)
+{
+    const auto &model = scene.model;
+
+    for (auto &object : scene.objects)
+    {
+        if (!object.alive)
+            continue;
+
+        for (auto base = object.indices.begin; base < object.indices.begin + object.indices.count; base += 3)
+        {
+            if (model.vertices[model.indices[base]].material != material)
+                continue;
+
+            remove_light(scene, base);
+            add_light(scene, base, emitting_area(scene, base));
+        }
+    }
+}
+
+std::uint32_t add_material(editable_scene_t &scene, const std::string &name, const material_t &material)
+{
+    auto &model = scene.model;
+
+    if (const auto it = model.material_map.find(name); it != model.material_map.end())
+    {
+        replace_material(scene, it->second, material);
+        return it->second;
+    }
+
+    std::uint32_t index;
+    if (!scene.free_materials.empty())
+    {
+        index = scene.free_materials.back();
+        scene.free_materials.pop_back();
+        model.materials[index] = material;
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(model.materials.size());
+        model.materials.push_back(material);
+    }
+
+    model.material_map.emplace(name, index);
+    scene.dirty_materials.mark(index);
+    return index;
+}
+
+void replace_material(editable_scene_t &scene, const std::uint32_t material, const material_t &value)
+{
+    const trace_zone_t zone("replace_material");
+
+    auto &current = scene.model.materials.at(material);
+    const auto was_emissive = current.is_emissive();
+
+    current = value;
+    scene.dirty_materials.mark(material);
+
+    // light sampling weighs triangles by area alone, so only switching emission on or off touches the list
+    if (was_emissive != value.is_emissive())
+        relight_material(scene, material);
+}
+
+bool remove_material(editable_scene_t &scene, const std::uint32_t material)
+{
+    auto &model = scene.model;
+
+    if (material >= model.materials.size())
+        return false;
+
+    for (auto &object : scene.objects)
+    {
+        if (!object.alive)
+            continue;
+
+        const auto begin = model.vertices.begin() + object.vertices.begin;
+        const auto end = begin + object.vertices.count;
+        if (std::any_of(
+            begin,
+            end,
+            [material](const vertex_t &vertex)
+            {
+                return vertex.material == material;
+            }))
+            return false;
+    }
+
+    std::erase_if(
+        model.material_map,
+        [material](const auto &entry)
+        {
+            return entry.second == material;
+        });
+
+    model.materials[material] = {};
+    scene.dirty_materials.mark(material);
+    scene.free_materials.push_back(material);
+    return true;
+}
+
+bool has_edits(const editable_scene_t &scene)
+{
+    return !scene.dirty_indices.empty()
+           || !scene.dirty_vertices.empty()
+           || !scene.dirty_materials.empty()
+           || !scene.dirty_nodes.empty()
+           || !scene.dirty_map.empty()
+           || !scene.dirty_lights.empty();
+}
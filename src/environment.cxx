@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <glrt/environment.hxx>
+#include <glrt/trace.hxx>
+
+bool read_environment(const std::filesystem::path &path, image_t &image)
+{
+    const trace_zone_t zone("read_environment");
+
+    if (path.extension() == ".hdr")
+        return read_hdr(path, image);
+
+    if (!read_pfm(path, image))
+        return false;
+
+    const auto row = static_cast<std::size_t>(image.width) * 3;
+    for (std::uint32_t y = 0; y < image.height / 2; ++y)
+        std::swap_ranges(
+            image.pixels.begin() + static_cast<std::ptrdiff_t>(y * row),
+            image.pixels.begin() + static_cast<std::ptrdiff_t>((y + 1) * row),
+            image.pixels.begin() + static_cast<std::ptrdiff_t>((image.height - 1 - y) * row));
+
+    return true;
+}
+
+static float luminance(const vec3f &c)
+{
+    return 0.2126f * c[0] + 0.7152f * c[1] + 0.0722f * c[2];
+}
+
+// Vose's method: overfull and underfull entries are paired until every bucket holds exactly the average weight
+static void build_alias_table(const std::vector<double> &weights, std::vector<alias_entry_t> &table)
+{
+    const auto count = weights.size();
+    table.assign(count, {});
+
+    double total = 0.0;
+    for (const auto weight : weights)
+        total += weight;
+
+    std::vector<double> scaled(count);
+    std::vector<std::uint32_t> small, large;
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        scaled[i] = total > 0.0 ? weights[i] * static_cast<double>(count) / total : 1.0;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        const auto s = small.back();
+        small.pop_back();
+        const auto l = large.back();
+
+        table[s] = { static_cast<float>(scaled[s]), l };
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // what is left is 1 up to rounding
+    for (const auto i : large)
+        table[i] = { 1.0f, i };
+    for (const auto i : small)
+        table[i] = { 1.0f, i };
+}
+
+void build_environment(const image_t &image, environment_t &environment)
+{
+    const trace_zone_t zone("build_environment");
+
+    environment.width = image.width;
+    environment.height = image.height;
+
+    const auto count = static_cast<std::size_t>(image.width) * image.height;
+    environment.texels.resize(count);
+
+    std::vector<double> weights(count);
+    double total = 0.0;
+
+    for (std::uint32_t y = 0; y < image.height; ++y)
+    {
+        const auto theta = (static_cast<double>(y) + 0.5) / image.height * std::numbers::pi;
+        const auto sin_theta = std::sin(theta);
+
+        for (std::uint32_t x = 0; x < image.width; ++x)
+        {
+            const auto i = static_cast<std::size_t>(y) * image.width + x;
+            const auto pixel = &image.pixels[i * 3];
+
+            auto &texel = environment.texels[i];
+            texel.radiance = { pixel[0], pixel[1], pixel[2] };
+
+            weights[i] = std::max(static_cast<double>(luminance(texel.radiance)), 0.0) * sin_theta;
+            total += weights[i];
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+        environment.texels[i].pdf = static_cast<float>(total > 0.0 ? weights[i] / total : 1.0 / count);
+
+    std::vector<alias_entry_t> alias;
+    build_alias_table(weights, alias);
+
+    for (std::size_t i = 0; i < count; ++i)
+        environment.texels[i].alias = alias[i];
+}
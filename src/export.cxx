@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <glrt/export.hxx>
+#include <glrt/jobs.hxx>
+#include <glrt/trace.hxx>
+
+// rows per job when converting a readback into its ring slot
+static constexpr std::size_t PUBLISH_GRAIN = 32;
+
+static double seconds_since(const std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+bool open_export(
+    frame_export_t &frame_export,
+    const std::string &name,
+    const frame_format_t format,
+    const std::uint32_t width,
+    const std::uint32_t height)
+{
+    const auto slot_bytes = static_cast<std::size_t>(width) * height * frame_pixel_bytes(format);
+    return create_frame_ring(name, format, slot_bytes, frame_export.ring);
+}
+
+// persistently mapped, so a finished copy is read straight out of the buffer without another map call
+static void reserve_readback(readback_t &readback, const std::size_t bytes)
+{
+    if (readback.capacity >= bytes)
+        return;
+
+    constexpr GLbitfield access = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    readback.buffer = gl::Buffer();
+    readback.buffer.Storage(nullptr, bytes, access | GL_CLIENT_STORAGE_BIT);
+    readback.pixels = readback.buffer.MapRange(0, bytes, access);
+    readback.capacity = bytes;
+}
+
+void queue_export(const context_t &context, frame_export_t &frame_export)
+{
+    if (!frame_export.ring.memory)
+        return;
+
+    publish_exports(frame_export);
+
+    const trace_zone_t zone("queue_export");
+    const auto begin = std::chrono::steady_clock::now();
+
+    auto &readback = frame_export.readbacks[frame_export.next];
+    if (readback.pending)
+    {
+        ++frame_export.dropped;
+        return;
+    }
+
+    const gpu_zone_t gpu_zone("export_readback");
+
+    const auto format = ring_header(frame_export.ring).format;
+    const auto width = context.data.extent[0];
+    const auto height = context.data.extent[1];
+    const auto bytes = static_cast<std::size_t>(width) * height * frame_pixel_bytes(format);
+
+    reserve_readback(readback, bytes);
+
+    // with a pack buffer bound the pixel pointer is an offset into it, and the call returns once the copy is queued.
+    // ldr frames come from the back buffer default.frag just tonemapped, a quarter of the bytes of the accumulation
+    readback.buffer.Bind(GL_PIXEL_PACK_BUFFER);
+
+    if (format == FRAME_RGBA8)
+        glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    else
+    {
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        context.accumulation.GetSubImage(
+            0,
+            0,
+            0,
+            static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height),
+            GL_RGBA,
+            GL_FLOAT,
+            static_cast<GLsizei>(bytes),
+            nullptr);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence.Insert();
+
+    readback.width = width;
+    readback.height = height;
+    readback.samples = std::min(context.data.frame / tile_count(context), context.data.extent[2]);
+    readback.pending = true;
+
+    frame_export.next = (frame_export.next + 1) % EXPORT_READBACKS;
+    ++frame_export.queued;
+    frame_export.queue_seconds += seconds_since(begin);
+}
+
+// gl rows run bottom to top; flipping them is free while copying
+static void write_frame(const readback_t &readback, const std::size_t row_bytes, std::byte *frame)
+{
+    const auto height = static_cast<std::size_t>(readback.height);
+    const auto source = static_cast<const std::byte *>(readback.pixels);
+
+    jobs().parallel_for(
+        0,
+        height,
+        PUBLISH_GRAIN,
+        [&](const std::size_t begin, const std::size_t end)
+        {
+            for (auto y = begin; y < end; ++y)
+                std::memcpy(frame + y * row_bytes, source + (height - 1 - y) * row_bytes, row_bytes);
+        });
+}
+
+static void publish_readback(frame_export_t &frame_export, readback_t &readback)
+{
+    const trace_zone_t zone("publish_export");
+    const auto begin = std::chrono::steady_clock::now();
+
+    readback.pending = false;
+
+    const auto row_bytes = readback.width * frame_pixel_bytes(ring_header(frame_export.ring).format);
+    const auto bytes = row_bytes * readback.height;
+
+    // the window grew past the slots; readers follow the name to the new segment
+    if (bytes > ring_header(frame_export.ring).slot_bytes && !resize_frame_ring(frame_export.ring, bytes))
+    {
+        std::cerr << "failed to resize " << frame_export.ring.name << std::endl;
+        ++frame_export.dropped;
+        return;
+    }
+
+    const auto frame = begin_frame(frame_export.ring, readback.width, readback.height, readback.samples);
+    write_frame(readback, row_bytes, frame);
+    publish_frame(frame_export.ring);
+
+    ++frame_export.published;
+    frame_export.publish_seconds += seconds_since(begin);
+}
+
+void publish_exports(frame_export_t &frame_export)
+{
+    if (!frame_export.ring.memory)
+        return;
+
+    // next is the oldest slot; frames go out in the order they were queued
+    for (std::size_t i = 0; i < EXPORT_READBACKS; ++i)
+    {
+        auto &readback = frame_export.readbacks[(frame_export.next + i) % EXPORT_READBACKS];
+        if (!readback.pending)
+            continue;
+
+        if (!readback.fence.Wait(0))
+            return;
+
+        publish_readback(frame_export, readback);
+    }
+}
+
+void close_export(frame_export_t &frame_export)
+{
+    if (!frame_export.ring.memory)
+        return;
+
+    for (std::size_t i = 0; i < EXPORT_READBACKS; ++i)
+    {
+        auto &readback = frame_export.readbacks[(frame_export.next + i) % EXPORT_READBACKS];
+        if (!readback.pending)
+            continue;
+
+        while (!readback.fence.Wait(1'000'000))
+            ;
+
+        publish_readback(frame_export, readback);
+    }
+
+    const auto per_frame = [](const double seconds, const std::uint64_t count)
+    {
+        return count ? seconds / static_cast<double>(count) * 1e6 : 0.0;
+    };
+
+    std::cerr << "export: " << frame_export.published << " frames published, " << frame_export.dropped
+            << " dropped, " << per_frame(frame_export.queue_seconds, frame_export.queued) << " us queue + "
+            << per_frame(frame_export.publish_seconds, frame_export.published) << " us publish per frame"
+            << std::endl;
+
+    close_frame_ring(frame_export.ring);
+}
@@ -0,0 +1,208 @@
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <glrt/frame_ring.hxx>
+
+// slots start on a page boundary, so every frame copy begins aligned
+static constexpr std::size_t DATA_ALIGNMENT = 4096;
+
+std::size_t frame_pixel_bytes(const frame_format_t format)
+{
+    return format == FRAME_RGBA32F ? 4 * sizeof(float) : 4;
+}
+
+static std::byte *ring_slot(const frame_ring_t &ring, const std::size_t slot)
+{
+    const auto &header = ring_header(ring);
+    return static_cast<std::byte *>(ring.memory) + header.data_offset + slot * header.slot_bytes;
+}
+
+frame_ring_header_t &ring_header(const frame_ring_t &ring)
+{
+    return *static_cast<frame_ring_header_t *>(ring.memory);
+}
+
+bool create_frame_ring(
+    const std::string &name,
+    const frame_format_t format,
+    const std::size_t slot_bytes,
+    frame_ring_t &ring)
+{
+    constexpr auto data_offset = (sizeof(frame_ring_header_t) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    const auto size = data_offset + FRAME_RING_SLOTS * slot_bytes;
+
+    // readers still mapping an old segment keep it; the name moves on to the new one
+    shm_unlink(name.c_str());
+
+    const auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return false;
+
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    const auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every slot sequence and the frame count start at 0
+    const auto header = new(memory) frame_ring_header_t{
+        .magic = FRAME_RING_MAGIC,
+        .version = FRAME_RING_VERSION,
+        .format = format,
+        .slot_count = FRAME_RING_SLOTS,
+        .slot_bytes = slot_bytes,
+        .data_offset = data_offset,
+    };
+    header->state.store(FRAME_RING_OPEN, std::memory_order_release);
+
+    ring = { .name = name, .memory = memory, .size = size, .owner = true };
+    return true;
+}
+
+bool open_frame_ring(const std::string &name, frame_ring_t &ring)
+{
+    const auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat status{};
+    if (fstat(fd, &status) < 0 || static_cast<std::size_t>(status.st_size) < sizeof(frame_ring_header_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+    const auto memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+        return false;
+
+    ring = { .name = name, .memory = memory, .size = size };
+
+    const auto &header = ring_header(ring);
+    if (header.magic != FRAME_RING_MAGIC
+        || header.version != FRAME_RING_VERSION
+        || header.slot_count != FRAME_RING_SLOTS
+        || header.data_offset + header.slot_count * header.slot_bytes > size)
+    {
+        close_frame_ring(ring);
+        return false;
+    }
+
+    return true;
+}
+
+bool resize_frame_ring(frame_ring_t &ring, const std::size_t slot_bytes)
+{
+    const auto name = ring.name;
+    const auto format = ring_header(ring).format;
+
+    ring_header(ring).state.store(FRAME_RING_STALE, std::memory_order_release);
+    munmap(ring.memory, ring.size);
+    ring = {};
+
+    return create_frame_ring(name, format, slot_bytes, ring);
+}
+
+void close_frame_ring(frame_ring_t &ring)
+{
+    if (!ring.memory)
+        return;
+
+    if (ring.owner)
+    {
+        ring_header(ring).state.store(FRAME_RING_CLOSED, std::memory_order_release);
+        shm_unlink(ring.name.c_str());
+    }
+
+    munmap(ring.memory, ring.size);
+    ring = {};
+}
+
+std::byte *begin_frame(
+    const frame_ring_t &ring,
+    const std::uint32_t width,
+    const std::uint32_t height,
+    const std::uint32_t samples)
+{
+    auto &header = ring_header(ring);
+
+    const auto frame = header.frames.load(std::memory_order_relaxed) + 1;
+    auto &slot = header.slots[(frame - 1) % header.slot_count];
+
+    slot.sequence.store(2 * frame - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.width = width;
+    slot.height = height;
+    slot.samples = samples;
+
+    return ring_slot(ring, (frame - 1) % header.slot_count);
+}
+
+void publish_frame(const frame_ring_t &ring)
+{
+    auto &header = ring_header(ring);
+
+    const auto frame = header.frames.load(std::memory_order_relaxed) + 1;
+    auto &slot = header.slots[(frame - 1) % header.slot_count];
+
+    // steady_clock is CLOCK_MONOTONIC, so readers on the same machine can take latency against their own clock
+    slot.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    slot.sequence.store(2 * frame, std::memory_order_release);
+    header.frames.store(frame, std::memory_order_release);
+}
+
+bool read_frame(const frame_ring_t &ring, frame_info_t &info, std::vector<std::byte> &pixels)
+{
+    const auto &header = ring_header(ring);
+
+    const auto frame = header.frames.load(std::memory_order_acquire);
+    if (frame <= info.frame)
+        return false;
+
+    const auto index = (frame - 1) % header.slot_count;
+    const auto &slot = header.slots[index];
+
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * frame)
+        return false;
+
+    const auto width = slot.width;
+    const auto height = slot.height;
+    const auto samples = slot.samples;
+    const auto time_ns = slot.time_ns;
+
+    const auto bytes = static_cast<std::size_t>(width) * height * frame_pixel_bytes(header.format);
+    if (bytes > header.slot_bytes)
+        return false;
+
+    pixels.resize(bytes);
+    std::memcpy(pixels.data(), ring_slot(ring, index), bytes);
+
+    // the writer lapping the ring mid-copy shows up as a changed sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        return false;
+
+    info = { .frame = frame, .width = width, .height = height, .samples = samples, .time_ns = time_ns };
+    return true;
+}
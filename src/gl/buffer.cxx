@@ -28,7 +28,49 @@ void gl::Buffer::Data(const void *buffer, const std::size_t length, const GLenum
     glNamedBufferData(m_Handle, static_cast<GLsizeiptr>(length), buffer, usage);
 }
 
+void gl::Buffer::Storage(const void *buffer, const std::size_t length, const GLbitfield flags) const
+{
+    glNamedBufferStorage(m_Handle, static_cast<GLsizeiptr>(length), buffer, flags);
+}
+
+void gl::Buffer::SubData(const std::size_t offset, const void *buffer, const std::size_t length) const
+{
+    glNamedBufferSubData(m_Handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(length), buffer);
+}
+
+void gl::Buffer::GetSubData(const std::size_t offset, void *buffer, const std::size_t length) const
+{
+    glGetNamedBufferSubData(m_Handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(length), buffer);
+}
+
+void gl::Buffer::Clear(const GLenum internal_format, const GLenum format, const GLenum type, const void *data) const
+{
+    glClearNamedBufferData(m_Handle, internal_format, format, type, data);
+}
+
 void gl::Buffer::Bind(const GLenum target, const GLuint index) const
 {
     glBindBufferBase(target, index, m_Handle);
 }
+
+void gl::Buffer::Bind(const GLenum target) const
+{
+    glBindBuffer(target, m_Handle);
+}
+
+void *gl::Buffer::MapRange(const std::size_t offset, const std::size_t length, const GLbitfield access) const
+{
+    return glMapNamedBufferRange(m_Handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(length), access);
+}
+
+void gl::Buffer::Unmap() const
+{
+    glUnmapNamedBuffer(m_Handle);
+}
+
+std::size_t gl::Buffer::Size() const
+{
+    GLint64 size{};
+    glGetNamedBufferParameteri64v(m_Handle, GL_BUFFER_SIZE, &size);
+    return static_cast<std::size_t>(size);
+}
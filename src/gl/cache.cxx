@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <glrt/gl.hxx>
+
+static constexpr std::uint32_t CACHE_MAGIC = 0x42505247u; // "GRPB"
+
+static bool read_file(const std::filesystem::path &path, std::vector<char> &data)
+{
+    std::ifstream stream(path, std::ifstream::ate | std::ifstream::binary);
+    if (!stream)
+        return false;
+
+    data.resize(stream.tellg());
+    stream.seekg(0, std::ios::beg);
+    stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(stream);
+}
+
+static void hash_bytes(std::uint64_t &hash, const void *data, const std::size_t length)
+{
+    const auto bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+
+static void hash_string(std::uint64_t &hash, const GLenum name)
+{
+    const auto str = reinterpret_cast<const char *>(glGetString(name));
+    const std::string_view view = str ? str : "";
+    hash_bytes(hash, view.data(), view.size() + 1);
+}
+
+gl::ProgramCache::ProgramCache(std::filesystem::path directory)
+    : m_Directory(std::move(directory))
+{
+}
+
+void gl::ProgramCache::Load(
+    const Program &program,
+    const std::initializer_list<ShaderStage> stages,
+    Error &error) const
+{
+    error.reset();
+
+    std::vector<std::vector<char>> binaries;
+    binaries.reserve(stages.size());
+
+    std::uint64_t key = 0xcbf29ce484222325ull;
+    hash_string(key, GL_VENDOR);
+    hash_string(key, GL_RENDERER);
+    hash_string(key, GL_VERSION);
+
+    for (auto &stage : stages)
+    {
+        auto &binary = binaries.emplace_back();
+        if (!read_file(stage.path, binary))
+        {
+            error = Error(1, "failed to read shader binary " + stage.path.string());
+            return;
+        }
+
+        const std::uint64_t length = binary.size();
+        hash_bytes(key, &stage.type, sizeof(stage.type));
+        hash_bytes(key, &length, sizeof(length));
+        hash_bytes(key, binary.data(), binary.size());
+
+        for (auto &[index, value] : stage.constants)
+        {
+            hash_bytes(key, &index, sizeof(index));
+            hash_bytes(key, &value, sizeof(value));
+        }
+    }
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    const auto path = m_Directory / name.str();
+
+    GLint format_count{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+    if (std::vector<char> cached; format_count && read_file(path, cached) && cached.size() > 2 * sizeof(std::uint32_t))
+    {
+        std::uint32_t header[2];
+        std::memcpy(header, cached.data(), sizeof(header));
+
+        if (header[0] == CACHE_MAGIC)
+        {
+            program.Binary(
+                header[1],
+                cached.data() + sizeof(header),
+                static_cast<GLsizei>(cached.size() - sizeof(header)),
+                error);
+            if (!error)
+                return;
+
+            error.reset();
+        }
+    }
+
+    auto binary = binaries.begin();
+    for (auto &stage : stages)
+    {
+        const Shader shader(stage.type);
+        shader.Binary(
+            GL_SHADER_BINARY_FORMAT_SPIR_V,
+            binary->data(),
+            static_cast<GLsizei>(binary->size()),
+            stage.constants,
+            error);
+        if (error)
+            return;
+
+        program.Attach(shader);
+        ++binary;
+    }
+
+    if (format_count)
+        program.Parameter(GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    program.Link(error);
+    if (error || !format_count)
+        return;
+
+    GLenum format{};
+    std::vector<char> data;
+    program.GetBinary(format, data);
+    if (data.empty())
+        return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_Directory, ec);
+
+    // processes starting together may build the same program; each writes its own file and renames it into place,
+    // so readers only ever see a whole blob
+    auto temporary = path;
+    temporary += "." + std::to_string(getpid()) + ".tmp";
+
+    const std::uint32_t header[2]{ CACHE_MAGIC, format };
+    {
+        std::ofstream stream(temporary, std::ofstream::binary | std::ofstream::trunc);
+        stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!stream.flush())
+        {
+            stream.close();
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary, path, ec);
+    if (ec)
+        std::filesystem::remove(temporary, ec);
+}
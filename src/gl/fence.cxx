@@ -0,0 +1,35 @@
+#include <utility>
+#include <glrt/gl.hxx>
+
+gl::Fence::Fence() = default;
+
+gl::Fence::~Fence()
+{
+    glDeleteSync(m_Handle);
+    m_Handle = nullptr;
+}
+
+gl::Fence::Fence(Fence &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+}
+
+gl::Fence &gl::Fence::operator=(Fence &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+    return *this;
+}
+
+void gl::Fence::Insert()
+{
+    glDeleteSync(m_Handle);
+    m_Handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool gl::Fence::Wait(const GLuint64 timeout) const
+{
+    if (!m_Handle)
+        return true;
+
+    return glClientWaitSync(m_Handle, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) != GL_TIMEOUT_EXPIRED;
+}
@@ -0,0 +1,57 @@
+#include <utility>
+#include <glrt/gl.hxx>
+
+gl::Framebuffer::Framebuffer()
+{
+    glCreateFramebuffers(1, &m_Handle);
+}
+
+gl::Framebuffer::~Framebuffer()
+{
+    glDeleteFramebuffers(1, &m_Handle);
+    m_Handle = 0;
+}
+
+gl::Framebuffer::Framebuffer(Framebuffer &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+}
+
+gl::Framebuffer &gl::Framebuffer::operator=(Framebuffer &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+    return *this;
+}
+
+void gl::Framebuffer::Bind(const GLenum target) const
+{
+    glBindFramebuffer(target, m_Handle);
+}
+
+void gl::Framebuffer::Attach(const GLenum attachment, const Texture &texture, const GLint level) const
+{
+    glNamedFramebufferTexture(m_Handle, attachment, texture.m_Handle, level);
+}
+
+void gl::Framebuffer::DrawBuffers(const std::initializer_list<GLenum> buffers) const
+{
+    glNamedFramebufferDrawBuffers(m_Handle, static_cast<GLsizei>(buffers.size()), buffers.begin());
+}
+
+void gl::Framebuffer::ClearColor(const GLint buffer, const GLfloat *value) const
+{
+    glClearNamedFramebufferfv(m_Handle, GL_COLOR, buffer, value);
+}
+
+void gl::Framebuffer::ClearDepth(const GLfloat value) const
+{
+    glClearNamedFramebufferfv(m_Handle, GL_DEPTH, 0, &value);
+}
+
+void gl::Framebuffer::CheckStatus(const GLenum target, Error &error) const
+{
+    error.reset();
+
+    if (const auto status = glCheckNamedFramebufferStatus(m_Handle, target); status != GL_FRAMEBUFFER_COMPLETE)
+        error = Error(static_cast<int>(status), "incomplete framebuffer");
+}
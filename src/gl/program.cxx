@@ -79,6 +79,8 @@ void gl::Program::Binary(
     const GLsizei length,
     Error &error) const
 {
+    error.reset();
+
     glProgramBinary(m_Handle, format, binary, length);
 
     GLint status;
@@ -94,6 +96,34 @@ void gl::Program::Binary(
     }
 }
 
+void gl::Program::GetBinary(GLenum &format, std::vector<char> &binary) const
+{
+    GLint length;
+    glGetProgramiv(m_Handle, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    binary.resize(length);
+    if (!length)
+        return;
+
+    glGetProgramBinary(m_Handle, length, &length, &format, binary.data());
+    binary.resize(length);
+}
+
+void gl::Program::Parameter(const GLenum name, const GLint value) const
+{
+    glProgramParameteri(m_Handle, name, value);
+}
+
+void gl::Program::Uniform(const GLint location, const GLuint value) const
+{
+    glProgramUniform1ui(m_Handle, location, value);
+}
+
+void gl::Program::Uniform(const GLint location, const GLfloat value) const
+{
+    glProgramUniform1f(m_Handle, location, value);
+}
+
 void gl::Program::LoadShaderSource(
     const std::filesystem::path &path,
     const GLenum type,
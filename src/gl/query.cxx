@@ -0,0 +1,36 @@
+#include <utility>
+#include <glrt/gl.hxx>
+
+gl::Query::Query(const GLenum target)
+{
+    glCreateQueries(target, 1, &m_Handle);
+}
+
+gl::Query::~Query()
+{
+    glDeleteQueries(1, &m_Handle);
+    m_Handle = 0;
+}
+
+gl::Query::Query(Query &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+}
+
+gl::Query &gl::Query::operator=(Query &&other) noexcept
+{
+    std::swap(m_Handle, other.m_Handle);
+    return *this;
+}
+
+void gl::Query::Counter() const
+{
+    glQueryCounter(m_Handle, GL_TIMESTAMP);
+}
+
+GLuint64 gl::Query::Result() const
+{
+    GLuint64 result{};
+    glGetQueryObjectui64v(m_Handle, GL_QUERY_RESULT, &result);
+    return result;
+}
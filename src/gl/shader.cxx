@@ -1,5 +1,6 @@
 #include <system_error>
 #include <utility>
+#include <vector>
 #include <glrt/gl.hxx>
 
 gl::Shader::Shader(const GLenum type)
@@ -30,11 +31,37 @@ void gl::Shader::Source(const GLchar *source, const GLint length) const
 }
 
 void gl::Shader::Binary(const GLenum format, const void *binary, const GLsizei length, Error &error) const
+{
+    Binary(format, binary, length, {}, error);
+}
+
+void gl::Shader::Binary(
+    const GLenum format,
+    const void *binary,
+    const GLsizei length,
+    const std::vector<SpecializationConstant> &constants,
+    Error &error) const
 {
     error.reset();
 
+    std::vector<GLuint> indices;
+    std::vector<GLuint> values;
+    indices.reserve(constants.size());
+    values.reserve(constants.size());
+
+    for (auto &[index, value] : constants)
+    {
+        indices.push_back(index);
+        values.push_back(value);
+    }
+
     glShaderBinary(1, &m_Handle, format, binary, length);
-    glSpecializeShader(m_Handle, "main", 0, nullptr, nullptr);
+    glSpecializeShader(
+        m_Handle,
+        "main",
+        static_cast<GLuint>(constants.size()),
+        indices.data(),
+        values.data());
 
     GLint status;
     glGetShaderiv(m_Handle, GL_COMPILE_STATUS, &status);
@@ -60,3 +60,53 @@ void gl::Texture::BindImage(
         access,
         format);
 }
+
+void gl::Texture::GetSubImage(
+    const GLint level,
+    const GLint x,
+    const GLint y,
+    const GLsizei width,
+    const GLsizei height,
+    const GLenum format,
+    const GLenum type,
+    const GLsizei size,
+    void *pixels) const
+{
+    glGetTextureSubImage(
+        m_Handle,
+        level,
+        x,
+        y,
+        0,
+        width,
+        height,
+        1,
+        format,
+        type,
+        size,
+        pixels);
+}
+
+void gl::Texture::ClearSubImage(
+    const GLint level,
+    const GLint x,
+    const GLint y,
+    const GLsizei width,
+    const GLsizei height,
+    const GLenum format,
+    const GLenum type,
+    const void *data) const
+{
+    glClearTexSubImage(
+        m_Handle,
+        level,
+        x,
+        y,
+        0,
+        width,
+        height,
+        1,
+        format,
+        type,
+        data);
+}
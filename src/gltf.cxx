@@ -0,0 +1,812 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <glrt/gltf.hxx>
+#include <glrt/model.hxx>
+#include <glrt/scene.hxx>
+#include <glrt/trace.hxx>
+#include <glrt/types.hxx>
+
+constexpr std::uint32_t GLB_MAGIC = 0x46546c67;
+constexpr std::uint32_t GLB_VERSION = 2;
+constexpr std::uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+constexpr std::uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+constexpr std::uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr std::uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr std::uint32_t COMPONENT_UNSIGNED_INT = 5125;
+constexpr std::uint32_t COMPONENT_FLOAT = 5126;
+
+constexpr std::uint32_t MODE_TRIANGLES = 4;
+
+// glTF itself nests a handful of levels; extensions and extras get generous room
+constexpr unsigned JSON_MAX_DEPTH = 64;
+
+class mapped_file_t
+{
+public:
+    explicit mapped_file_t(const std::filesystem::path &path)
+    {
+        const auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat info{};
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            const auto size = static_cast<std::size_t>(info.st_size);
+            if (const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); data != MAP_FAILED)
+            {
+                m_Data = static_cast<const std::byte *>(data);
+                m_Size = size;
+            }
+        }
+
+        close(fd);
+    }
+
+    ~mapped_file_t()
+    {
+        if (m_Data)
+            munmap(const_cast<std::byte *>(m_Data), m_Size);
+    }
+
+    mapped_file_t(const mapped_file_t &) = delete;
+    mapped_file_t &operator=(const mapped_file_t &) = delete;
+
+    mapped_file_t(mapped_file_t &&other) noexcept
+    {
+        std::swap(m_Data, other.m_Data);
+        std::swap(m_Size, other.m_Size);
+    }
+
+    [[nodiscard]] const std::byte *data() const
+    {
+        return m_Data;
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return m_Size;
+    }
+
+private:
+    const std::byte *m_Data{};
+    std::size_t m_Size{};
+};
+
+/* json */
+
+// strings are views into the mapped chunk and keep their escapes; glTF only needs them for keys and names
+struct json_t
+{
+    enum kind_t
+    {
+        JSON_NULL,
+        JSON_BOOL,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT,
+    };
+
+    const json_t &operator[](const std::string_view key) const
+    {
+        for (auto &[name, value] : object)
+            if (name == key)
+                return value;
+        return null();
+    }
+
+    const json_t &operator[](const std::size_t index) const
+    {
+        return index < array.size() ? array[index] : null();
+    }
+
+    [[nodiscard]] bool contains(const std::string_view key) const
+    {
+        return &(*this)[key] != &null();
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return array.size();
+    }
+
+    [[nodiscard]] float as_float(const float fallback = 0.0f) const
+    {
+        return kind == JSON_NUMBER ? static_cast<float>(number) : fallback;
+    }
+
+    [[nodiscard]] std::uint32_t as_uint(const std::uint32_t fallback = 0) const
+    {
+        return kind == JSON_NUMBER ? static_cast<std::uint32_t>(number) : fallback;
+    }
+
+    static const json_t &null()
+    {
+        static const json_t value;
+        return value;
+    }
+
+    kind_t kind = JSON_NULL;
+    bool boolean{};
+    double number{};
+    std::string_view string;
+    std::vector<json_t> array;
+    std::vector<std::pair<std::string_view, json_t>> object;
+};
+
+struct json_parser_t
+{
+    const char *ptr;
+    const char *end;
+};
+
+static void skip_space(json_parser_t &parser)
+{
+    while (parser.ptr < parser.end
+           && (*parser.ptr == ' ' || *parser.ptr == '\t' || *parser.ptr == '\n' || *parser.ptr == '\r'))
+        ++parser.ptr;
+}
+
+static bool consume(json_parser_t &parser, const char c)
+{
+    skip_space(parser);
+    if (parser.ptr == parser.end || *parser.ptr != c)
+        return false;
+    ++parser.ptr;
+    return true;
+}
+
+static bool parse_string(json_parser_t &parser, std::string_view &str)
+{
+    if (!consume(parser, '"'))
+        return false;
+
+    const auto begin = parser.ptr;
+    while (parser.ptr < parser.end && *parser.ptr != '"')
+        parser.ptr += *parser.ptr == '\\' ? 2 : 1;
+
+    if (parser.ptr >= parser.end)
+        return false;
+
+    str = { begin, static_cast<std::size_t>(parser.ptr - begin) };
+    ++parser.ptr;
+    return true;
+}
+
+static bool parse_literal(json_parser_t &parser, const std::string_view literal)
+{
+    if (static_cast<std::size_t>(parser.end - parser.ptr) < literal.size()
+        || std::string_view(parser.ptr, literal.size()) != literal)
+        return false;
+
+    parser.ptr += literal.size();
+    return true;
+}
+
+// depth counts open arrays and objects; past JSON_MAX_DEPTH the file is rejected instead of exhausting the stack
+static bool parse_value(json_parser_t &parser, json_t &value, const unsigned depth = 0)
+{
+    skip_space(parser);
+    if (parser.ptr == parser.end)
+        return false;
+
+    if ((*parser.ptr == '{' || *parser.ptr == '[') && depth >= JSON_MAX_DEPTH)
+        return false;
+
+    switch (*parser.ptr)
+    {
+    case '{':
+        value.kind = json_t::JSON_OBJECT;
+        ++parser.ptr;
+        if (consume(parser, '}'))
+            return true;
+        do
+        {
+            auto &[key, member] = value.object.emplace_back();
+            if (!parse_string(parser, key) || !consume(parser, ':') || !parse_value(parser, member, depth + 1))
+                return false;
+        }
+        while (consume(parser, ','));
+        return consume(parser, '}');
+
+    case '[':
+        value.kind = json_t::JSON_ARRAY;
+        ++parser.ptr;
+        if (consume(parser, ']'))
+            return true;
+        do
+        {
+            if (!parse_value(parser, value.array.emplace_back(), depth + 1))
+                return false;
+        }
+        while (consume(parser, ','));
+        return consume(parser, ']');
+
+    case '"':
+        value.kind = json_t::JSON_STRING;
+        return parse_string(parser, value.string);
+
+    case 't':
+        value.kind = json_t::JSON_BOOL;
+        value.boolean = true;
+        return parse_literal(parser, "true");
+
+    case 'f':
+        value.kind = json_t::JSON_BOOL;
+        return parse_literal(parser, "false");
+
+    case 'n':
+        return parse_literal(parser, "null");
+
+    default:
+    {
+        value.kind = json_t::JSON_NUMBER;
+        const auto [ptr, ec] = std::from_chars(parser.ptr, parser.end, value.number);
+        parser.ptr = ptr;
+        return ec == std::errc();
+    }
+    }
+}
+
+/* glb */
+
+struct glb_header_t
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t length;
+};
+
+struct glb_chunk_t
+{
+    std::uint32_t length;
+    std::uint32_t type;
+};
+
+struct gltf_t
+{
+    json_t json;
+    std::vector<std::pair<const std::byte *, std::size_t>> buffers;
+    std::vector<mapped_file_t> files;
+};
+
+struct accessor_view_t
+{
+    const std::byte *data;
+    std::size_t count;
+    std::size_t stride;
+    std::uint32_t component_type;
+    std::uint32_t components;
+    bool normalized;
+};
+
+static std::uint32_t component_size(const std::uint32_t component_type)
+{
+    switch (component_type)
+    {
+    case COMPONENT_UNSIGNED_BYTE:
+        return 1;
+    case COMPONENT_UNSIGNED_SHORT:
+        return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static std::uint32_t component_count(const std::string_view type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    return 0;
+}
+
+static bool get_accessor(const gltf_t &gltf, const json_t &index, accessor_view_t &view)
+{
+    if (index.kind != json_t::JSON_NUMBER)
+        return false;
+
+    const auto &accessor = gltf.json["accessors"][index.as_uint()];
+    const auto &buffer_view = gltf.json["bufferViews"][accessor["bufferView"].as_uint(0xffffffffu)];
+
+    // sparse accessors and accessors without a view would need a materialized copy
+    if (buffer_view.kind != json_t::JSON_OBJECT || accessor.contains("sparse"))
+        return false;
+
+    const auto buffer = buffer_view["buffer"].as_uint();
+    if (buffer >= gltf.buffers.size())
+        return false;
+
+    view = {
+        .count = accessor["count"].as_uint(),
+        .component_type = accessor["componentType"].as_uint(),
+        .components = component_count(accessor["type"].string),
+        .normalized = accessor["normalized"].boolean,
+    };
+
+    const auto element = component_size(view.component_type) * view.components;
+    view.stride = buffer_view["byteStride"].as_uint(element);
+
+    const auto offset = static_cast<std::size_t>(buffer_view["byteOffset"].as_uint())
+                        + accessor["byteOffset"].as_uint();
+    const auto length = buffer_view["byteLength"].as_uint();
+
+    if (!element || !view.count)
+        return false;
+
+    if (accessor["byteOffset"].as_uint() + (view.count - 1) * view.stride + element > length
+        || offset + (view.count - 1) * view.stride + element > gltf.buffers[buffer].second)
+        return false;
+
+    view.data = gltf.buffers[buffer].first + offset;
+    return true;
+}
+
+static float read_component(const accessor_view_t &view, const std::byte *element, const std::uint32_t component)
+{
+    switch (view.component_type)
+    {
+    case COMPONENT_FLOAT:
+    {
+        float value;
+        std::memcpy(&value, element + component * 4, 4);
+        return value;
+    }
+    case COMPONENT_UNSIGNED_BYTE:
+    {
+        const auto value = static_cast<float>(std::to_integer<std::uint8_t>(element[component]));
+        return view.normalized ? value / 255.0f : value;
+    }
+    case COMPONENT_UNSIGNED_SHORT:
+    {
+        std::uint16_t value;
+        std::memcpy(&value, element + component * 2, 2);
+        return view.normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+// float attributes are copied straight out of the mapping; only quantized ones are converted per component
+template<unsigned N>
+static void read_attribute(const accessor_view_t &view, vertex_t *vertices, vec<N, float> vertex_t::*member)
+{
+    if (view.component_type == COMPONENT_FLOAT)
+    {
+        for (std::size_t i = 0; i < view.count; ++i)
+            std::memcpy((vertices[i].*member).e, view.data + i * view.stride, N * sizeof(float));
+        return;
+    }
+
+    for (std::size_t i = 0; i < view.count; ++i)
+        for (unsigned k = 0; k < N; ++k)
+            (vertices[i].*member)[k] = read_component(view, view.data + i * view.stride, k);
+}
+
+static void read_indices(const accessor_view_t &view, const std::uint32_t base, std::vector<std::uint32_t> &indices)
+{
+    const auto first = indices.size();
+    indices.resize(first + view.count);
+
+    auto dst = indices.data() + first;
+
+    if (view.component_type == COMPONENT_UNSIGNED_INT && view.stride == 4)
+    {
+        std::memcpy(dst, view.data, view.count * 4);
+        if (base)
+            for (std::size_t i = 0; i < view.count; ++i)
+                dst[i] += base;
+        return;
+    }
+
+    for (std::size_t i = 0; i < view.count; ++i)
+    {
+        const auto element = view.data + i * view.stride;
+
+        std::uint32_t value{};
+        switch (view.component_type)
+        {
+        case COMPONENT_UNSIGNED_BYTE:
+            value = std::to_integer<std::uint8_t>(element[0]);
+            break;
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            std::uint16_t value16;
+            std::memcpy(&value16, element, 2);
+            value = value16;
+            break;
+        }
+        case COMPONENT_UNSIGNED_INT:
+            std::memcpy(&value, element, 4);
+            break;
+        default:
+            break;
+        }
+        dst[i] = value + base;
+    }
+}
+
+// area weighted vertex normals for primitives that ship without them
+static void generate_normals(model_t &model, const std::size_t first_index, const std::uint32_t base)
+{
+    for (auto i = first_index; i + 2 < model.indices.size(); i += 3)
+    {
+        auto &v0 = model.vertices[model.indices[i + 0]];
+        auto &v1 = model.vertices[model.indices[i + 1]];
+        auto &v2 = model.vertices[model.indices[i + 2]];
+
+        const auto n = cross(v1.position - v0.position, v2.position - v0.position);
+        v0.normal = v0.normal + n;
+        v1.normal = v1.normal + n;
+        v2.normal = v2.normal + n;
+    }
+
+    for (auto i = static_cast<std::size_t>(base); i < model.vertices.size(); ++i)
+        if (auto &normal = model.vertices[i].normal; length_squared(normal) > 0.0f)
+            normal = normalize(normal);
+}
+
+static material_t read_material(const json_t &material)
+{
+    const auto &pbr = material["pbrMetallicRoughness"];
+    const auto &base_color = pbr["baseColorFactor"];
+    const auto &emissive = material["emissiveFactor"];
+
+    const auto &extensions = material["extensions"];
+    const auto strength = extensions["KHR_materials_emissive_strength"]["emissiveStrength"].as_float(1.0f);
+    const auto &sheen = extensions["KHR_materials_sheen"];
+    const auto &clearcoat = extensions["KHR_materials_clearcoat"];
+
+    material_t result{
+        .albedo = { base_color[0].as_float(1.0f), base_color[1].as_float(1.0f), base_color[2].as_float(1.0f) },
+        .emission = vec3f{ emissive[0].as_float(), emissive[1].as_float(), emissive[2].as_float() } * strength,
+        .roughness = pbr["roughnessFactor"].as_float(1.0f),
+        .metallic = pbr["metallicFactor"].as_float(1.0f),
+        .clearcoat_thickness = clearcoat["clearcoatFactor"].as_float(),
+        .clearcoat_roughness = clearcoat["clearcoatRoughnessFactor"].as_float(),
+    };
+
+    // the shader's sheen is a single weight; the brightest channel of the tint stands in for it
+    const auto &sheen_color = sheen["sheenColorFactor"];
+    result.sheen = std::max({ sheen_color[0].as_float(), sheen_color[1].as_float(), sheen_color[2].as_float() });
+
+    return result;
+}
+
+// a primitive without a material gets the default, the last remap slot; an index outside the materials array fails
+static bool use_material(
+    const gltf_t &gltf,
+    const json_t &index,
+    model_t &model,
+    std::vector<std::uint32_t> &remap,
+    std::uint32_t &result)
+{
+    const auto count = gltf.json["materials"].size();
+
+    auto material = static_cast<std::uint32_t>(count);
+    if (index.kind != json_t::JSON_NULL)
+    {
+        if (index.kind != json_t::JSON_NUMBER || !(index.number >= 0.0) || index.number >= static_cast<double>(count))
+            return false;
+        material = index.as_uint();
+    }
+
+    if (remap[material] != 0xffffffffu)
+    {
+        result = remap[material];
+        return true;
+    }
+
+    std::string name;
+    if (const auto &json = gltf.json["materials"][material]; json.kind == json_t::JSON_OBJECT)
+    {
+        name = json.contains("name") ? std::string(json["name"].string) : "material#" + std::to_string(material);
+        model.materials.push_back(read_material(json));
+    }
+    else
+    {
+        name = "default";
+        model.materials.push_back(read_material(json_t::null()));
+    }
+
+    remap[material] = static_cast<std::uint32_t>(model.materials.size() - 1);
+    model.material_map.emplace(std::move(name), remap[material]);
+    result = remap[material];
+    return true;
+}
+
+static bool read_mesh(const gltf_t &gltf, const json_t &mesh, model_t &model)
+{
+    std::vector<std::uint32_t> remap(gltf.json["materials"].size() + 1, 0xffffffffu);
+
+    for (auto &primitive : mesh["primitives"].array)
+    {
+        if (primitive["mode"].as_uint(MODE_TRIANGLES) != MODE_TRIANGLES)
+            continue;
+
+        const auto &attributes = primitive["attributes"];
+
+        accessor_view_t positions;
+        if (!get_accessor(gltf, attributes["POSITION"], positions)
+            || positions.components != 3 || positions.component_type != COMPONENT_FLOAT)
+            return false;
+
+        const auto base = static_cast<std::uint32_t>(model.vertices.size());
+        const auto first_index = model.indices.size();
+
+        std::uint32_t material;
+        if (!use_material(gltf, primitive["material"], model, remap, material))
+            return false;
+
+        model.vertices.resize(base + positions.count, { .material = material });
+        const auto vertices = model.vertices.data() + base;
+
+        read_attribute(positions, vertices, &vertex_t::position);
+
+        accessor_view_t view;
+        const auto has_normals = get_accessor(gltf, attributes["NORMAL"], view)
+                                 && view.components == 3 && view.count == positions.count;
+        if (has_normals)
+            read_attribute(view, vertices, &vertex_t::normal);
+
+        if (get_accessor(gltf, attributes["TEXCOORD_0"], view) && view.components == 2 && view.count == positions.count)
+            read_attribute(view, vertices, &vertex_t::texture);
+
+        if (primitive.contains("indices"))
+        {
+            if (!get_accessor(gltf, primitive["indices"], view) || view.components != 1)
+                return false;
+            read_indices(view, base, model.indices);
+        }
+        else
+        {
+            for (std::uint32_t i = 0; i < positions.count; ++i)
+                model.indices.push_back(base + i);
+        }
+
+        model.indices.resize(first_index + (model.indices.size() - first_index) / 3 * 3);
+
+        if (std::any_of(model.indices.begin() + static_cast<std::ptrdiff_t>(first_index), model.indices.end(),
+                        [&](const auto index) { return index >= model.vertices.size(); }))
+            return false;
+
+        if (!has_normals)
+            generate_normals(model, first_index, base);
+    }
+
+    return true;
+}
+
+static mat4f node_transform(const json_t &node)
+{
+    mat4f m;
+
+    // glTF matrices are column major, mat4f is indexed [row][column]
+    if (const auto &matrix = node["matrix"]; matrix.size() == 16)
+    {
+        for (unsigned i = 0; i < 16; ++i)
+            m[i % 4][i / 4] = matrix[i].as_float();
+        return m;
+    }
+
+    const auto &t = node["translation"];
+    const auto &r = node["rotation"];
+    const auto &s = node["scale"];
+
+    const auto x = r[0].as_float(), y = r[1].as_float(), z = r[2].as_float(), w = r[3].as_float(1.0f);
+    const float rotation[3][3]{
+        { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w) },
+        { 2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w) },
+        { 2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y) },
+    };
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+            m[i][j] = rotation[i][j] * s[j].as_float(1.0f);
+        m[i][3] = t[i].as_float();
+    }
+    m[3][3] = 1.0f;
+
+    return m;
+}
+
+static void collect_instances(
+    const gltf_t &gltf,
+    const std::uint32_t index,
+    const mat4f &parent,
+    const unsigned depth,
+    std::vector<std::pair<std::uint32_t, mat4f>> &instances)
+{
+    const auto &node = gltf.json["nodes"][index];
+    if (node.kind != json_t::JSON_OBJECT || depth > 64)
+        return;
+
+    const auto transform = parent * node_transform(node);
+
+    if (node.contains("mesh"))
+        instances.emplace_back(node["mesh"].as_uint(), transform);
+
+    for (auto &child : node["children"].array)
+        collect_instances(gltf, child.as_uint(), transform, depth + 1, instances);
+}
+
+static int hex_digit(const char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// relative uris are percent-encoded, so "my%20mesh.bin" names "my mesh.bin"; a truncated escape or a decoded nul fails
+static bool decode_uri(const std::string_view uri, std::string &path)
+{
+    path.clear();
+    path.reserve(uri.size());
+
+    for (std::size_t i = 0; i < uri.size(); ++i)
+    {
+        if (uri[i] != '%')
+        {
+            path.push_back(uri[i]);
+            continue;
+        }
+
+        if (i + 2 >= uri.size())
+            return false;
+
+        const auto high = hex_digit(uri[i + 1]);
+        const auto low = hex_digit(uri[i + 2]);
+        if (high < 0 || low < 0 || (high | low) == 0)
+            return false;
+
+        path.push_back(static_cast<char>(high << 4 | low));
+        i += 2;
+    }
+
+    return !path.empty();
+}
+
+static bool open_glb(const std::filesystem::path &path, const mapped_file_t &file, gltf_t &gltf)
+{
+    if (file.size() < sizeof(glb_header_t) + sizeof(glb_chunk_t))
+        return false;
+
+    glb_header_t header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != GLB_MAGIC || header.version != GLB_VERSION || header.length > file.size())
+        return false;
+
+    std::pair<const std::byte *, std::size_t> bin{};
+
+    std::string_view json;
+    for (std::size_t offset = sizeof(header); offset + sizeof(glb_chunk_t) <= header.length;)
+    {
+        glb_chunk_t chunk;
+        std::memcpy(&chunk, file.data() + offset, sizeof(chunk));
+        offset += sizeof(chunk);
+
+        if (offset + chunk.length > header.length)
+            return false;
+
+        if (chunk.type == GLB_CHUNK_JSON && json.empty())
+            json = { reinterpret_cast<const char *>(file.data() + offset), chunk.length };
+        else if (chunk.type == GLB_CHUNK_BIN && !bin.first)
+            bin = { file.data() + offset, chunk.length };
+
+        offset += (chunk.length + 3) & ~3u;
+    }
+
+    json_parser_t parser{ json.data(), json.data() + json.size() };
+    if (json.empty() || !parse_value(parser, gltf.json) || gltf.json.kind != json_t::JSON_OBJECT)
+        return false;
+
+    // the first buffer without a uri is the BIN chunk; others are mapped from files next to the .glb
+    for (auto &buffer : gltf.json["buffers"].array)
+    {
+        if (!buffer.contains("uri"))
+        {
+            gltf.buffers.push_back(bin);
+            continue;
+        }
+
+        const auto uri = buffer["uri"].string;
+        if (uri.starts_with("data:"))
+            return false;
+
+        std::string file;
+        if (!decode_uri(uri, file))
+            return false;
+
+        auto &mapped = gltf.files.emplace_back(path.parent_path() / file);
+        gltf.buffers.emplace_back(mapped.data(), mapped.size());
+    }
+
+    return true;
+}
+
+bool read_glb(const std::filesystem::path &path, model_t &model)
+{
+    const trace_zone_t zone("read_glb");
+
+    const mapped_file_t file(path);
+
+    gltf_t gltf;
+    if (!open_glb(path, file, gltf))
+        return false;
+
+    const auto &mesh_json = gltf.json["meshes"];
+
+    std::vector<model_t> meshes(mesh_json.size());
+    for (std::size_t i = 0; i < meshes.size(); ++i)
+        if (!read_mesh(gltf, mesh_json[i], meshes[i]))
+            return false;
+
+    std::vector<std::pair<std::uint32_t, mat4f>> instances;
+
+    const auto &scenes = gltf.json["scenes"];
+    if (scenes.size())
+    {
+        for (auto &root : scenes[gltf.json["scene"].as_uint()]["nodes"].array)
+            collect_instances(gltf, root.as_uint(), identity<4, float>(), 0, instances);
+    }
+    else
+    {
+        // without a scene every node that is nobody's child is a root
+        std::vector<bool> is_child(gltf.json["nodes"].size());
+        for (auto &node : gltf.json["nodes"].array)
+            for (auto &child : node["children"].array)
+                if (child.as_uint() < is_child.size())
+                    is_child[child.as_uint()] = true;
+
+        for (std::uint32_t i = 0; i < is_child.size(); ++i)
+            if (!is_child[i])
+                collect_instances(gltf, i, identity<4, float>(), 0, instances);
+    }
+
+    std::vector<std::uint32_t> uses(meshes.size());
+    for (auto &[mesh, transform] : instances)
+        if (mesh < meshes.size())
+            uses[mesh]++;
+
+    // a mesh placed once moves into the builder, shared meshes are copied per instance
+    scene_builder_t builder;
+    for (auto &[mesh, transform] : instances)
+    {
+        if (mesh >= meshes.size())
+            continue;
+
+        if (uses[mesh] == 1)
+            builder.add(std::move(meshes[mesh]), transform);
+        else
+            builder.add(meshes[mesh], transform);
+    }
+
+    builder.build(model);
+    return true;
+}
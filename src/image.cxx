@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <glrt/image.hxx>
+
+bool read_pfm(const std::filesystem::path &path, image_t &image)
+{
+    std::ifstream stream(path, std::ifstream::binary);
+    if (!stream)
+        return false;
+
+    std::string magic;
+    float scale;
+    stream >> magic >> image.width >> image.height >> scale;
+    stream.get();
+
+    if (!stream || magic != "PF" || scale >= 0.0f)
+        return false;
+
+    image.channels = 3;
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 3);
+    stream.read(
+        reinterpret_cast<char *>(image.pixels.data()),
+        static_cast<std::streamsize>(image.pixels.size() * sizeof(float)));
+    return static_cast<bool>(stream);
+}
+
+bool write_pfm(const std::filesystem::path &path, const image_t &image)
+{
+    std::ofstream stream(path, std::ofstream::binary | std::ofstream::trunc);
+    if (!stream)
+        return false;
+
+    stream << (image.channels == 1 ? "Pf\n" : "PF\n") << image.width << ' ' << image.height << "\n-1.0\n";
+    stream.write(
+        reinterpret_cast<const char *>(image.pixels.data()),
+        static_cast<std::streamsize>(image.pixels.size() * sizeof(float)));
+    return static_cast<bool>(stream);
+}
+
+static bool read_hdr_scanline(std::ifstream &stream, const std::uint32_t width, std::vector<std::uint8_t> &rgbe)
+{
+    std::uint8_t head[4];
+    if (!stream.read(reinterpret_cast<char *>(head), 4))
+        return false;
+
+    // flat scanline; the first pixel is already in head
+    if (width < 8 || width > 0x7fff || head[0] != 2 || head[1] != 2 || static_cast<std::uint32_t>(head[2] << 8 | head[3]) != width)
+    {
+        std::copy_n(head, 4, rgbe.begin());
+        return static_cast<bool>(stream.read(reinterpret_cast<char *>(rgbe.data() + 4), (width - 1) * 4));
+    }
+
+    // run-length encoded, one channel after the other
+    for (std::uint32_t channel = 0; channel < 4; ++channel)
+    {
+        for (std::uint32_t x = 0; x < width;)
+        {
+            const auto count = stream.get();
+            if (count == std::ifstream::traits_type::eof())
+                return false;
+
+            if (count > 128)
+            {
+                const auto value = static_cast<std::uint8_t>(stream.get());
+                const auto run = static_cast<std::uint32_t>(count - 128);
+                if (x + run > width)
+                    return false;
+
+                for (std::uint32_t i = 0; i < run; ++i, ++x)
+                    rgbe[x * 4 + channel] = value;
+            }
+            else
+            {
+                const auto run = static_cast<std::uint32_t>(count);
+                if (!run || x + run > width)
+                    return false;
+
+                for (std::uint32_t i = 0; i < run; ++i, ++x)
+                    rgbe[x * 4 + channel] = static_cast<std::uint8_t>(stream.get());
+            }
+        }
+    }
+
+    return static_cast<bool>(stream);
+}
+
+bool read_hdr(const std::filesystem::path &path, image_t &image)
+{
+    std::ifstream stream(path, std::ifstream::binary);
+    if (!stream)
+        return false;
+
+    std::string line;
+    if (!std::getline(stream, line) || !line.starts_with("#?"))
+        return false;
+
+    while (std::getline(stream, line) && !line.empty())
+        if (line.starts_with("FORMAT=") && line != "FORMAT=32-bit_rle_rgbe")
+            return false;
+
+    std::string y_axis, x_axis;
+    stream >> y_axis >> image.height >> x_axis >> image.width;
+    stream.get();
+
+    if (!stream || y_axis != "-Y" || x_axis != "+X")
+        return false;
+
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 3);
+
+    std::vector<std::uint8_t> rgbe(static_cast<std::size_t>(image.width) * 4);
+    for (std::uint32_t y = 0; y < image.height; ++y)
+    {
+        if (!read_hdr_scanline(stream, image.width, rgbe))
+            return false;
+
+        auto pixel = image.pixels.data() + static_cast<std::size_t>(y) * image.width * 3;
+        for (std::uint32_t x = 0; x < image.width; ++x, pixel += 3)
+        {
+            const auto scale = rgbe[x * 4 + 3] ? std::ldexp(1.0f, rgbe[x * 4 + 3] - (128 + 8)) : 0.0f;
+            for (std::uint32_t c = 0; c < 3; ++c)
+                pixel[c] = static_cast<float>(rgbe[x * 4 + c]) * scale;
+        }
+    }
+
+    return true;
+}
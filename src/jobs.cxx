@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <string>
+#include <glrt/jobs.hxx>
+#include <glrt/trace.hxx>
+
+static thread_local const job_system_t *t_System{};
+static thread_local unsigned t_Queue{};
+
+job_system_t::job_system_t(const unsigned thread_count)
+{
+    const auto count = std::max(thread_count, 1u);
+
+    for (unsigned i = 0; i < count; ++i)
+        m_Queues.push_back(std::make_unique<queue_t>());
+
+    // queue 0 belongs to whichever outside thread spawns; every worker owns one of the others
+    for (unsigned i = 1; i < count; ++i)
+        m_Threads.emplace_back(&job_system_t::worker, this, i);
+}
+
+job_system_t::~job_system_t()
+{
+    m_Running = false;
+    {
+        std::lock_guard lock(m_SleepMutex);
+    }
+    m_Wake.notify_all();
+
+    for (auto &thread : m_Threads)
+        thread.join();
+}
+
+unsigned job_system_t::thread_count() const
+{
+    return static_cast<unsigned>(m_Queues.size());
+}
+
+unsigned job_system_t::current_queue() const
+{
+    return t_System == this ? t_Queue : 0;
+}
+
+void job_system_t::spawn(job_group_t &group, std::function<void()> job)
+{
+    if (m_Threads.empty())
+    {
+        job();
+        return;
+    }
+
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        auto &queue = *m_Queues[current_queue()];
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back({ std::move(job), &group });
+    }
+
+    m_Queued.fetch_add(1, std::memory_order_release);
+
+    // a worker between checking m_Queued and sleeping holds the mutex, so it cannot miss this notification
+    {
+        std::lock_guard lock(m_SleepMutex);
+    }
+    m_Wake.notify_one();
+}
+
+bool job_system_t::run_one(const unsigned index)
+{
+    job_t job{};
+    auto found = false;
+
+    {
+        auto &own = *m_Queues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // steal the oldest, and so usually the largest, job of another queue
+    for (std::size_t i = 1; !found && i < m_Queues.size(); ++i)
+    {
+        auto &victim = *m_Queues[(index + i) % m_Queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    m_Queued.fetch_sub(1, std::memory_order_relaxed);
+
+    job.function();
+    job.group->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void job_system_t::wait(job_group_t &group)
+{
+    const auto index = current_queue();
+
+    while (group.pending.load(std::memory_order_acquire))
+        if (!run_one(index))
+            std::this_thread::yield();
+}
+
+void job_system_t::worker(const unsigned index)
+{
+    t_System = this;
+    t_Queue = index;
+
+    trace_thread_name("jobs " + std::to_string(index));
+
+    while (m_Running)
+    {
+        if (run_one(index))
+            continue;
+
+        std::unique_lock lock(m_SleepMutex);
+        m_Wake.wait(
+            lock,
+            [this]
+            {
+                return !m_Running || m_Queued.load(std::memory_order_acquire);
+            });
+    }
+}
+
+void job_system_t::split_range(
+    job_group_t &group,
+    const std::size_t begin,
+    std::size_t end,
+    const std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &body)
+{
+    // the upper half goes to the queue first, so thieves take large ranges and split them further
+    while (end - begin > grain)
+    {
+        const auto mid = begin + (end - begin) / 2;
+        spawn(
+            group,
+            [this, &group, mid, end, grain, &body]
+            {
+                split_range(group, mid, end, grain, body);
+            });
+        end = mid;
+    }
+
+    body(begin, end);
+}
+
+void job_system_t::parallel_for(
+    const std::size_t begin,
+    const std::size_t end,
+    const std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &body)
+{
+    if (begin >= end)
+        return;
+
+    const auto min_grain = std::max<std::size_t>(grain, 1);
+
+    if (m_Threads.empty() || end - begin <= min_grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    job_group_t group;
+    split_range(group, begin, end, min_grain, body);
+    wait(group);
+}
+
+job_system_t &jobs(const unsigned thread_count)
+{
+    static job_system_t system(thread_count ? thread_count : std::max(std::thread::hardware_concurrency(), 1u));
+    return system;
+}
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <functional>
+#include <glrt/jobs.hxx>
+#include <glrt/kernel.hxx>
+#include <glrt/trace.hxx>
+
+// a multiple of the widest simd batch, so every vertex takes the same path as in one serial pass
+static constexpr std::size_t TRANSFORM_CHUNK = 4096;
+
+static void transform_vertex(const mat4f &transform, const mat3f &normal_transform, vertex_t &vertex)
+{
+    vertex.position = transform * vertex.position;
+    vertex.normal = normalize(normal_transform * vertex.normal);
+}
+
+#ifdef GLRT_SIMD
+
+struct soa_mat4_t
+{
+    __m128 m[4][4];
+};
+
+struct soa_mat3_t
+{
+    __m128 m[3][3];
+};
+
+static soa_mat4_t broadcast(const mat4f &a)
+{
+    soa_mat4_t s;
+    for (unsigned i = 0; i < 4; ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            s.m[i][j] = _mm_set1_ps(a[i][j]);
+    return s;
+}
+
+static soa_mat3_t broadcast(const mat3f &a)
+{
+    soa_mat3_t s;
+    for (unsigned i = 0; i < 3; ++i)
+        for (unsigned j = 0; j < 3; ++j)
+            s.m[i][j] = _mm_set1_ps(a[i][j]);
+    return s;
+}
+
+static __m128 madd(const __m128 a, const __m128 b, const __m128 c)
+{
+#ifdef __FMA__
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+static void transform_points4(const soa_mat4_t &m, __m128 &x, __m128 &y, __m128 &z)
+{
+    const auto tx = madd(m.m[0][0], x, madd(m.m[0][1], y, madd(m.m[0][2], z, m.m[0][3])));
+    const auto ty = madd(m.m[1][0], x, madd(m.m[1][1], y, madd(m.m[1][2], z, m.m[1][3])));
+    const auto tz = madd(m.m[2][0], x, madd(m.m[2][1], y, madd(m.m[2][2], z, m.m[2][3])));
+    const auto tw = madd(m.m[3][0], x, madd(m.m[3][1], y, madd(m.m[3][2], z, m.m[3][3])));
+
+    x = _mm_div_ps(tx, tw);
+    y = _mm_div_ps(ty, tw);
+    z = _mm_div_ps(tz, tw);
+}
+
+static void transform_normals4(const soa_mat3_t &m, __m128 &x, __m128 &y, __m128 &z)
+{
+    const auto tx = madd(m.m[0][0], x, madd(m.m[0][1], y, _mm_mul_ps(m.m[0][2], z)));
+    const auto ty = madd(m.m[1][0], x, madd(m.m[1][1], y, _mm_mul_ps(m.m[1][2], z)));
+    const auto tz = madd(m.m[2][0], x, madd(m.m[2][1], y, _mm_mul_ps(m.m[2][2], z)));
+
+    const auto length = _mm_sqrt_ps(madd(tx, tx, madd(ty, ty, _mm_mul_ps(tz, tz))));
+
+    x = _mm_div_ps(tx, length);
+    y = _mm_div_ps(ty, length);
+    z = _mm_div_ps(tz, length);
+}
+
+static void transform_vertices4(const soa_mat4_t &m, const soa_mat3_t &n, vertex_t *vertices)
+{
+    auto x = _mm_load_ps(vertices[0].position.e);
+    auto y = _mm_load_ps(vertices[1].position.e);
+    auto z = _mm_load_ps(vertices[2].position.e);
+    auto w = _mm_load_ps(vertices[3].position.e);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    transform_points4(m, x, y, z);
+
+    w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_store_ps(vertices[0].position.e, x);
+    _mm_store_ps(vertices[1].position.e, y);
+    _mm_store_ps(vertices[2].position.e, z);
+    _mm_store_ps(vertices[3].position.e, w);
+
+    x = _mm_load_ps(vertices[0].normal.e);
+    y = _mm_load_ps(vertices[1].normal.e);
+    z = _mm_load_ps(vertices[2].normal.e);
+    w = _mm_load_ps(vertices[3].normal.e);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    transform_normals4(n, x, y, z);
+
+    w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_store_ps(vertices[0].normal.e, x);
+    _mm_store_ps(vertices[1].normal.e, y);
+    _mm_store_ps(vertices[2].normal.e, z);
+    _mm_store_ps(vertices[3].normal.e, w);
+}
+
+#ifdef __AVX__
+
+struct soa8_mat4_t
+{
+    __m256 m[4][4];
+};
+
+struct soa8_mat3_t
+{
+    __m256 m[3][3];
+};
+
+static soa8_mat4_t broadcast8(const mat4f &a)
+{
+    soa8_mat4_t s;
+    for (unsigned i = 0; i < 4; ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            s.m[i][j] = _mm256_set1_ps(a[i][j]);
+    return s;
+}
+
+static soa8_mat3_t broadcast8(const mat3f &a)
+{
+    soa8_mat3_t s;
+    for (unsigned i = 0; i < 3; ++i)
+        for (unsigned j = 0; j < 3; ++j)
+            s.m[i][j] = _mm256_set1_ps(a[i][j]);
+    return s;
+}
+
+static __m256 madd(const __m256 a, const __m256 b, const __m256 c)
+{
+#ifdef __FMA__
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+static void load8(const vec3f vertex_t::*member, const vertex_t *vertices, __m256 &x, __m256 &y, __m256 &z)
+{
+    __m128 l[4], h[4];
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        l[i] = _mm_load_ps((vertices[i].*member).e);
+        h[i] = _mm_load_ps((vertices[i + 4].*member).e);
+    }
+    _MM_TRANSPOSE4_PS(l[0], l[1], l[2], l[3]);
+    _MM_TRANSPOSE4_PS(h[0], h[1], h[2], h[3]);
+
+    x = _mm256_set_m128(h[0], l[0]);
+    y = _mm256_set_m128(h[1], l[1]);
+    z = _mm256_set_m128(h[2], l[2]);
+}
+
+static void store8(vec3f vertex_t::*member, vertex_t *vertices, const __m256 x, const __m256 y, const __m256 z)
+{
+    __m128 l[4]
+    {
+        _mm256_castps256_ps128(x),
+        _mm256_castps256_ps128(y),
+        _mm256_castps256_ps128(z),
+        _mm_setzero_ps(),
+    };
+    __m128 h[4]
+    {
+        _mm256_extractf128_ps(x, 1),
+        _mm256_extractf128_ps(y, 1),
+        _mm256_extractf128_ps(z, 1),
+        _mm_setzero_ps(),
+    };
+    _MM_TRANSPOSE4_PS(l[0], l[1], l[2], l[3]);
+    _MM_TRANSPOSE4_PS(h[0], h[1], h[2], h[3]);
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        _mm_store_ps((vertices[i].*member).e, l[i]);
+        _mm_store_ps((vertices[i + 4].*member).e, h[i]);
+    }
+}
+
+static void transform_vertices8(const soa8_mat4_t &m, const soa8_mat3_t &n, vertex_t *vertices)
+{
+    __m256 x, y, z;
+
+    load8(&vertex_t::position, vertices, x, y, z);
+    {
+        const auto tx = madd(m.m[0][0], x, madd(m.m[0][1], y, madd(m.m[0][2], z, m.m[0][3])));
+        const auto ty = madd(m.m[1][0], x, madd(m.m[1][1], y, madd(m.m[1][2], z, m.m[1][3])));
+        const auto tz = madd(m.m[2][0], x, madd(m.m[2][1], y, madd(m.m[2][2], z, m.m[2][3])));
+        const auto tw = madd(m.m[3][0], x, madd(m.m[3][1], y, madd(m.m[3][2], z, m.m[3][3])));
+        store8(&vertex_t::position, vertices, _mm256_div_ps(tx, tw), _mm256_div_ps(ty, tw), _mm256_div_ps(tz, tw));
+    }
+
+    load8(&vertex_t::normal, vertices, x, y, z);
+    {
+        const auto tx = madd(n.m[0][0], x, madd(n.m[0][1], y, _mm256_mul_ps(n.m[0][2], z)));
+        const auto ty = madd(n.m[1][0], x, madd(n.m[1][1], y, _mm256_mul_ps(n.m[1][2], z)));
+        const auto tz = madd(n.m[2][0], x, madd(n.m[2][1], y, _mm256_mul_ps(n.m[2][2], z)));
+        const auto length = _mm256_sqrt_ps(madd(tx, tx, madd(ty, ty, _mm256_mul_ps(tz, tz))));
+        store8(&vertex_t::normal, vertices, _mm256_div_ps(tx, length), _mm256_div_ps(ty, length), _mm256_div_ps(tz, length));
+    }
+}
+
+#endif
+
+#endif
+
+static void transform_vertices(
+    const mat4f &transform,
+    const mat3f &normal_transform,
+    vertex_t *vertices,
+    const std::size_t count)
+{
+    std::size_t i = 0;
+
+#ifdef GLRT_SIMD
+#ifdef __AVX__
+    const auto m8 = broadcast8(transform);
+    const auto n8 = broadcast8(normal_transform);
+    for (; i + 8 <= count; i += 8)
+        transform_vertices8(m8, n8, vertices + i);
+#endif
+
+    const auto m4 = broadcast(transform);
+    const auto n4 = broadcast(normal_transform);
+    for (; i + 4 <= count; i += 4)
+        transform_vertices4(m4, n4, vertices + i);
+#endif
+
+    for (; i < count; ++i)
+        transform_vertex(transform, normal_transform, vertices[i]);
+}
+
+void transform_vertices(const mat4f &transform, vertex_t *vertices, const std::size_t count)
+{
+    const trace_zone_t zone("transform_vertices");
+
+    const auto normal_transform = inverse(transpose(static_cast<mat3f>(transform)));
+
+    const auto body = [&](const std::size_t begin, const std::size_t end)
+    {
+        const auto first = begin * TRANSFORM_CHUNK;
+        const auto last = std::min(end * TRANSFORM_CHUNK, count);
+        transform_vertices(transform, normal_transform, vertices + first, last - first);
+    };
+
+    // scene_builder_t calls this once per part; a reference wrapper fits std::function without a heap allocation
+    jobs().parallel_for(0, (count + TRANSFORM_CHUNK - 1) / TRANSFORM_CHUNK, 1, std::cref(body));
+}
+
+box_t vertex_bounds(const vertex_t *vertices, const std::size_t count)
+{
+    auto bounds = box_empty();
+
+    std::size_t i = 0;
+
+#ifdef GLRT_SIMD
+    auto min0 = simd::load(bounds.min), min1 = min0;
+    auto max0 = simd::load(bounds.max), max1 = max0;
+    for (; i + 2 <= count; i += 2)
+    {
+        const auto p0 = _mm_load_ps(vertices[i + 0].position.e);
+        const auto p1 = _mm_load_ps(vertices[i + 1].position.e);
+        min0 = _mm_min_ps(min0, p0);
+        max0 = _mm_max_ps(max0, p0);
+        min1 = _mm_min_ps(min1, p1);
+        max1 = _mm_max_ps(max1, p1);
+    }
+    bounds.min = simd::store3(_mm_min_ps(min0, min1));
+    bounds.max = simd::store3(_mm_max_ps(max0, max1));
+#endif
+
+    for (; i < count; ++i)
+    {
+        bounds.min = min(bounds.min, vertices[i].position);
+        bounds.max = max(bounds.max, vertices[i].position);
+    }
+
+    return bounds;
+}
+
+void triangle_bounds(
+    const triangle_t *triangles,
+    const std::size_t count,
+    box_t &bounds,
+    box_t &centroid_bounds)
+{
+    bounds = box_empty();
+    centroid_bounds = box_empty();
+
+#ifdef GLRT_SIMD
+    auto bounds_min = simd::load(bounds.min);
+    auto bounds_max = simd::load(bounds.max);
+    auto centroid_min = bounds_min;
+    auto centroid_max = bounds_max;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto centroid = simd::load(triangles[i].centroid);
+        bounds_min = _mm_min_ps(bounds_min, simd::load(triangles[i].bounds.min));
+        bounds_max = _mm_max_ps(bounds_max, simd::load(triangles[i].bounds.max));
+        centroid_min = _mm_min_ps(centroid_min, centroid);
+        centroid_max = _mm_max_ps(centroid_max, centroid);
+    }
+
+    bounds.min = simd::store3(bounds_min);
+    bounds.max = simd::store3(bounds_max);
+    centroid_bounds.min = simd::store3(centroid_min);
+    centroid_bounds.max = simd::store3(centroid_max);
+#else
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bounds = box_union(bounds, triangles[i].bounds);
+        centroid_bounds.min = min(centroid_bounds.min, triangles[i].centroid);
+        centroid_bounds.max = max(centroid_bounds.max, triangles[i].centroid);
+    }
+#endif
+}
@@ -1,63 +1,35 @@
-#include <filesystem>
-#include <fstream>
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <vector>
+#include <string>
+#include <unistd.h>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <glrt/benchmark.hxx>
 #include <glrt/bvh.hxx>
+#include <glrt/camera.hxx>
+#include <glrt/context.hxx>
+#include <glrt/distributed.hxx>
+#include <glrt/edit.hxx>
+#include <glrt/environment.hxx>
+#include <glrt/export.hxx>
 #include <glrt/gl.hxx>
+#include <glrt/gltf.hxx>
+#include <glrt/jobs.hxx>
 #include <glrt/math.hxx>
 #include <glrt/obj.hxx>
+#include <glrt/options.hxx>
+#include <glrt/paging.hxx>
+#include <glrt/scene.hxx>
+#include <glrt/trace.hxx>
+#include <glrt/variant.hxx>
 #include <glrt/window.hxx>
 
-struct uniform_data_t
-{
-    mat4f inv_view;
-    mat4f inv_proj;
-    vec3f origin;
-    float total_light_area{};
-    vec3u extent;
-    std::uint32_t frame{};
-    vec2u tile_extent;
-};
-
-struct context_t
-{
-    uniform_data_t data;
-
-    gl::VertexArray vertex_array;
-    gl::Texture accumulation;
-
-    gl::Buffer data_buffer;
-    gl::Buffer index_buffer;
-    gl::Buffer vertex_buffer;
-    gl::Buffer material_buffer;
-    gl::Buffer node_buffer;
-    gl::Buffer map_buffer;
-    gl::Buffer light_buffer;
-    gl::Buffer light_area_buffer;
-
-    gl::Program draw_program;
-    gl::Program compute_program;
-};
-
 static void framebuffer_size_callback(GLFWwindow *window, const int width, const int height)
 {
     const auto context = static_cast<context_t *>(glfwGetWindowUserPointer(window));
 
-    context->data.extent = {
-        static_cast<std::uint32_t>(width),
-        static_cast<std::uint32_t>(height),
-        1600u,
-    };
-    context->data.frame = {};
-
-    const auto proj = perspective(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 100.0f);
-    context->data.inv_proj = inverse(proj);
-
-    context->accumulation.Recreate(GL_TEXTURE_2D);
-    context->accumulation.Storage2D(1, GL_RGBA32F, width, height);
-    context->accumulation.BindImage(0, 0, false, 0, GL_READ_WRITE, GL_RGBA32F);
+    resize_accumulation(*context, width, height);
 
     glViewport(0, 0, width, height);
 }
@@ -76,193 +48,510 @@ static void debug_callback(
     std::cerr << message << std::endl;
 }
 
+struct input_state_t
+{
+    double cursor_x{};
+    double cursor_y{};
+    double time{};
+};
+
+// compute dispatches queued ahead of the cpu; bounds input latency without draining the queue
+constexpr std::size_t FRAMES_IN_FLIGHT = 3;
+
+struct frame_pacing_t
+{
+    std::array<gl::Fence, FRAMES_IN_FLIGHT> fences;
+    std::size_t next{};
+
+    double present_interval{};
+    double last_present{};
+    bool present_due = true;
+};
+
+// waits for the dispatch FRAMES_IN_FLIGHT submissions back before another one is queued
+static void pace_frame(const frame_pacing_t &pacing)
+{
+    while (!pacing.fences[pacing.next].Wait(1'000'000))
+        ;
+}
+
+static void submit_frame(frame_pacing_t &pacing)
+{
+    pacing.fences[pacing.next].Insert();
+    pacing.next = (pacing.next + 1) % FRAMES_IN_FLIGHT;
+}
+
+static bool update_camera(const Window &window, input_state_t &input, camera_t &camera)
+{
+    constexpr float move_speed = 4.0f;
+    constexpr float look_speed = 0.003f;
+    constexpr float max_pitch = 1.5f;
+
+    const auto time = glfwGetTime();
+    const auto dt = static_cast<float>(time - input.time);
+    input.time = time;
+
+    double cursor_x, cursor_y;
+    window.GetCursorPos(cursor_x, cursor_y);
+
+    const auto dx = static_cast<float>(cursor_x - input.cursor_x);
+    const auto dy = static_cast<float>(cursor_y - input.cursor_y);
+    input.cursor_x = cursor_x;
+    input.cursor_y = cursor_y;
+
+    auto moved = false;
+
+    if (window.GetMouseButton(GLFW_MOUSE_BUTTON_RIGHT) && (dx != 0.0f || dy != 0.0f))
+    {
+        camera.yaw += dx * look_speed;
+        camera.pitch = std::clamp(camera.pitch - dy * look_speed, -max_pitch, max_pitch);
+        moved = true;
+    }
+
+    vec3f direction;
+    if (window.GetKey(GLFW_KEY_W)) direction = direction + camera_forward(camera);
+    if (window.GetKey(GLFW_KEY_S)) direction = direction - camera_forward(camera);
+    if (window.GetKey(GLFW_KEY_D)) direction = direction + camera_right(camera);
+    if (window.GetKey(GLFW_KEY_A)) direction = direction - camera_right(camera);
+    if (window.GetKey(GLFW_KEY_E)) direction = direction + vec3f{ 0.0f, 1.0f, 0.0f };
+    if (window.GetKey(GLFW_KEY_Q)) direction = direction - vec3f{ 0.0f, 1.0f, 0.0f };
+
+    if (length_squared(direction) > 0.0f)
+    {
+        camera.position = camera.position + normalize(direction) * (move_speed * dt);
+        moved = true;
+    }
+
+    return moved;
+}
+
+// n drops a prop in front of the camera, x takes the last one away again
+struct edit_state_t
+{
+    model_t prop;
+    std::vector<std::uint32_t> inserted;
+    bool insert_held{};
+    bool remove_held{};
+};
+
+static void load_prop(model_t &prop)
+{
+    read_obj("asset/model/cube/cube.obj", prop);
+
+    prop.material_map.emplace("prop", 0);
+    prop.materials.push_back({ .albedo = { 0.8f, 0.8f, 0.8f }, .roughness = 0.5f });
+}
+
+static bool edit_scene(const Window &window, const camera_t &camera, edit_state_t &edit, editable_scene_t &scene)
+{
+    const auto insert = window.GetKey(GLFW_KEY_N);
+    const auto remove = window.GetKey(GLFW_KEY_X);
+
+    auto edited = false;
+
+    if (insert && !edit.insert_held)
+    {
+        const auto center = camera.position + camera_forward(camera) * 3.0f;
+        edit.inserted.push_back(
+            insert_mesh(scene, edit.prop, translation(center[0] - 0.5f, center[1] - 0.5f, center[2] - 0.5f)));
+        edited = true;
+    }
+
+    if (remove && !edit.remove_held && !edit.inserted.empty())
+    {
+        remove_mesh(scene, edit.inserted.back());
+        edit.inserted.pop_back();
+        edited = true;
+    }
+
+    edit.insert_held = insert;
+    edit.remove_held = remove;
+    return edited;
+}
+
+// from an edit to the end of the first frame presented with it, reported once that frame is through the gpu. the
+// readback stalls for that one frame, which only happens on edits
+struct edit_latency_t
+{
+    gl::Query upload{ GL_TIMESTAMP };
+    gl::Query presented{ GL_TIMESTAMP };
+    double time{};
+    bool pending{};
+};
+
+static void report_edit_latency(edit_latency_t &latency)
+{
+    latency.presented.Counter();
+
+    const auto gpu = static_cast<double>(latency.presented.Result() - latency.upload.Result()) * 1e-6;
+    std::cerr << "edit to first pixel: " << gpu << " ms on the gpu, " << (glfwGetTime() - latency.time) * 1e3
+            << " ms in all" << std::endl;
+
+    latency.pending = false;
+}
+
+// v steps through the debug views, c writes the counters behind them
+struct debug_keys_t
+{
+    bool view_held{};
+    bool write_held{};
+};
+
+static void write_counters(const options_t &options, const context_t &context)
+{
+    if (!write_debug_counters(context, options.debug_counters))
+        std::cerr << "failed to write " << options.debug_counters << "_*.pfm" << std::endl;
+}
+
+static bool debug_keys(const Window &window, const options_t &options, debug_keys_t &keys, context_t &context)
+{
+    const auto view = window.GetKey(GLFW_KEY_V);
+    const auto write = window.GetKey(GLFW_KEY_C);
+
+    auto changed = false;
+
+    if (view && !keys.view_held)
+    {
+        context.debug_view = static_cast<debug_view_t>((context.debug_view + 1) % DEBUG_VIEW_COUNT);
+        changed = true;
+    }
+
+    if (write && !keys.write_held)
+        write_counters(options, context);
+
+    keys.view_held = view;
+    keys.write_held = write;
+    return changed;
+}
+
 static void generate_scene(model_t &data)
 {
+    scene_builder_t builder;
+
     {
         model_t cornell;
         read_obj("asset/model/cornell/cornell.obj", cornell);
-        data += scale(4.0f, 4.0f, 4.0f) * cornell;
+        builder.add(std::move(cornell), scale(4.0f, 4.0f, 4.0f));
     }
 
     {
         model_t teapot;
         read_obj("asset/model/teapot/teapot.obj", teapot);
-        data += translation(0.0f, -4.0f, 0.0f) * teapot;
+        builder.add(std::move(teapot), translation(0.0f, -4.0f, 0.0f));
     }
+
+    builder.build(data);
 }
 
-int main()
+// identifies the scene a page file was cut from: its path, size and modification time, and the build settings that
+// shape the tree. external files a scene refers to are not covered; a stale page file has to be deleted by hand
+static std::uint64_t paged_scene_key(const options_t &options)
 {
-    constexpr vec3f origin{ 0.0f, 0.0f, 14.0f };
-    constexpr vec3f target{ 0.0f, 0.0f, 0.0f };
+    std::uint64_t size{};
+    std::uint64_t time{};
 
-    constexpr auto view = lookAt(origin, target, { 0.0f, 1.0f, 0.0f });
-    constexpr auto inv_view = inverse(view);
+    if (!options.scene.empty())
+    {
+        std::error_code ec;
+        size = std::filesystem::file_size(options.scene, ec);
+        time = static_cast<std::uint64_t>(std::filesystem::last_write_time(options.scene, ec).time_since_epoch().count());
+    }
 
-    model_t data;
-    generate_scene(data);
+    // fnv-1a over the path, then folded with the numbers
+    std::uint64_t key = 0xcbf29ce484222325ull;
+    for (const auto c : options.scene.string())
+        key = (key ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    for (const auto value : { size, time, std::uint64_t{ options.split_budget } })
+        key = (key ^ value) * 0x100000001b3ull;
+
+    return key;
+}
 
+static bool load_scene(const std::filesystem::path &path, model_t &data)
+{
+    const trace_zone_t zone("load_scene");
+
+    if (path.empty())
+    {
+        generate_scene(data);
+        return true;
+    }
+
+    if (path.extension() == ".glb")
+        return read_glb(path, data);
+
+    read_obj(path, data);
+    return !data.indices.empty();
+}
+
+static void end_trace(const options_t &options)
+{
+    if (!trace_end())
+        std::cerr << "failed to write " << options.trace << std::endl;
+}
+
+int main(const int argc, const char *const *argv)
+{
+    options_t options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    jobs(options.threads);
+
+    if (options.mode == MODE_COORDINATOR)
+        return run_coordinator(options, DEFAULT_TILE_EXTENT);
+
+    if (options.mode == MODE_BENCHMARK_SUITE)
+        return run_benchmark_suite(options);
+
+    if (!options.trace.empty())
+        trace_begin(options.trace);
+
+    camera_t camera{ .position = { 0.0f, 0.0f, 14.0f } };
+    const auto view = camera_view(camera);
+
+    const auto paged = options.page_budget != 0;
+
+    // without --page-file every process cuts its own pages, so concurrent runs never share one file
+    const auto page_path = options.page_file.empty()
+                               ? std::filesystem::path("cache") / ("pages." + std::to_string(getpid()) + ".bin")
+                               : options.page_file;
+    const auto page_key = paged_scene_key(options);
+
+    model_t data;
     bvh_t bvh;
-    build_bvh(data, bvh);
+    std::uint32_t page_count{};
 
-    const Window window;
+    // a page file from an earlier run of the same scene holds everything resident; the scene itself is never loaded
+    const auto resumed = paged && !options.page_file.empty() && read_paged_scene(page_path, page_key, data, bvh, page_count);
+
+    if (!resumed)
+    {
+        if (!load_scene(options.scene, data))
+        {
+            std::cerr << "failed to load " << options.scene << std::endl;
+            return 1;
+        }
+
+        build_bvh(data, bvh, { .split_budget = static_cast<float>(options.split_budget) / 100.0f });
+
+        if (options.compact_nodes && !compact_bvh(bvh))
+            std::cerr << "bounds too large to quantize, using full bvh nodes" << std::endl;
+    }
+
+    auto variant = select_variant(data);
+    variant.compact_nodes = !bvh.compact_nodes.empty();
+    variant.raster_primary = options.raster_primary;
+    variant.paged = paged;
+    variant.environment = !options.environment.empty();
+    variant.restir = options.restir;
+    variant.debug_counters = !options.debug_counters.empty();
+
+    image_t environment_image;
+    if (variant.environment && !read_environment(options.environment, environment_image))
+    {
+        std::cerr << "failed to load " << options.environment << std::endl;
+        return 1;
+    }
+
+    if (paged && !resumed && !page_bvh(data, bvh, page_path, page_key, page_count))
+    {
+        std::cerr << "failed to write " << page_path << std::endl;
+        return 1;
+    }
+
+    const Window window(static_cast<int>(options.width), static_cast<int>(options.height));
 
     context_t context
     {
         .data = {
-            .inv_view = inv_view,
-            .origin = origin,
-            .total_light_area = bvh.total_light_area,
-            .tile_extent = { 64u, 64u },
+            .inv_view = inverse(view),
+            .origin = camera.position,
+            .extent = { options.width, options.height, options.samples },
+            .tile_extent = DEFAULT_TILE_EXTENT,
         },
+        .view = view,
         .accumulation = gl::Texture(GL_TEXTURE_2D),
+        .guide = gl::Texture(GL_TEXTURE_2D),
+        .history = gl::Texture(GL_TEXTURE_2D),
+        .history_guide = gl::Texture(GL_TEXTURE_2D),
+        .gbuffer_position = gl::Texture(GL_TEXTURE_2D),
+        .gbuffer_normal = gl::Texture(GL_TEXTURE_2D),
+        .gbuffer_surface = gl::Texture(GL_TEXTURE_2D),
+        .gbuffer_depth = gl::Texture(GL_TEXTURE_2D),
+        .sample_state = gl::Texture(GL_TEXTURE_2D),
     };
 
     gl::Error error;
 
-    window.SetUserPointer(&context);
-    window.SetFramebufferSizeCallback(framebuffer_size_callback);
-
     glDebugMessageCallback(debug_callback, &context);
     glEnable(GL_DEBUG_OUTPUT);
     glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    context.data_buffer.Bind(GL_UNIFORM_BUFFER, 0);
-
-    context.index_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 1);
-    context.vertex_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 2);
-    context.material_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 3);
-    context.node_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 4);
-    context.map_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 5);
-    context.light_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 6);
-    context.light_area_buffer.Bind(GL_SHADER_STORAGE_BUFFER, 7);
-
-    context.index_buffer.Data(
-        data.indices.data(),
-        data.indices.size() * sizeof(std::uint32_t),
-        GL_STATIC_DRAW);
-    context.vertex_buffer.Data(
-        data.vertices.data(),
-        data.vertices.size() * sizeof(vertex_t),
-        GL_STATIC_DRAW);
-    context.material_buffer.Data(
-        data.materials.data(),
-        data.materials.size() * sizeof(material_t),
-        GL_STATIC_DRAW);
-    context.node_buffer.Data(
-        bvh.nodes.data(),
-        bvh.nodes.size() * sizeof(bvh_node_t),
-        GL_STATIC_DRAW);
-    context.map_buffer.Data(
-        bvh.map.data(),
-        bvh.map.size() * sizeof(std::uint32_t),
-        GL_STATIC_DRAW);
-    context.light_buffer.Data(
-        bvh.lights.data(),
-        bvh.lights.size() * sizeof(std::uint32_t),
-        GL_STATIC_DRAW);
-    context.light_area_buffer.Data(
-        bvh.light_areas.data(),
-        bvh.light_areas.size() * sizeof(std::uint32_t),
-        GL_STATIC_DRAW);
-
-    if (context.draw_program.LoadShaderBinary(
-        "asset/shader/default.vert.spv",
-        GL_VERTEX_SHADER,
-        GL_SHADER_BINARY_FORMAT_SPIR_V,
-        error); error)
-    {
-        std::cerr << error.message() << std::endl;
-        return error.code();
-    }
+    upload_scene(context, data, bvh);
 
-    if (context.draw_program.LoadShaderBinary(
-        "asset/shader/default.frag.spv",
-        GL_FRAGMENT_SHADER,
-        GL_SHADER_BINARY_FORMAT_SPIR_V,
-        error); error)
+    if (variant.environment)
     {
-        std::cerr << error.message() << std::endl;
-        return error.code();
+        environment_t environment;
+        build_environment(environment_image, environment);
+        upload_environment(context, environment);
     }
 
-    if (context.draw_program.Link(error); error)
+    if (load_programs(context, variant, error); error)
     {
         std::cerr << error.message() << std::endl;
         return error.code();
     }
 
-    if (context.draw_program.Validate(error); error)
+    if (variant.paged)
     {
-        std::cerr << error.message() << std::endl;
-        return error.code();
-    }
+        constexpr auto page_bytes = PAGE_NODES * sizeof(bvh_node_t) + PAGE_TRIANGLES * 3 * sizeof(vertex_t);
+        const auto slot_count = std::max<std::size_t>(options.page_budget * (1ull << 20) / page_bytes, 1);
 
-    if (context.compute_program.LoadShaderBinary(
-        "asset/shader/default.comp.spv",
-        GL_COMPUTE_SHADER,
-        GL_SHADER_BINARY_FORMAT_SPIR_V,
-        error); error)
-    {
-        std::cerr << error.message() << std::endl;
-        return error.code();
+        const auto opened = upload_pages(context, page_path, page_count, static_cast<std::uint32_t>(slot_count));
+
+        // the open stream keeps a per-process file alive until exit, however the process ends
+        if (options.page_file.empty())
+        {
+            std::error_code ec;
+            std::filesystem::remove(page_path, ec);
+        }
+
+        if (!opened)
+        {
+            std::cerr << "failed to open " << page_path << std::endl;
+            return 1;
+        }
     }
 
-    if (context.compute_program.Link(error); error)
+    // headless modes trace startup only; their first samples belong to the render loop they hand off to
+    if (options.mode == MODE_WORKER || options.mode == MODE_BENCHMARK)
+        end_trace(options);
+
+    if (options.mode == MODE_WORKER)
+        return run_worker(options, context);
+
+    if (options.mode == MODE_BENCHMARK)
+        return run_benchmark(options, context);
+
+    // edits relink full nodes in place; compact and paged trees would need a rebuild
+    const auto editable = !variant.compact_nodes && !variant.paged;
+
+    editable_scene_t scene;
+    edit_state_t edit;
+
+    if (editable)
     {
-        std::cerr << error.message() << std::endl;
-        return error.code();
+        make_editable(std::move(data), std::move(bvh), scene);
+        reserve_edits(context, scene);
+        load_prop(edit.prop);
     }
 
-    if (context.compute_program.Validate(error); error)
+    frame_export_t frame_export;
+
+    if (!options.export_name.empty()
+        && !open_export(
+            frame_export,
+            options.export_name,
+            options.export_raw ? FRAME_RGBA32F : FRAME_RGBA8,
+            options.width,
+            options.height))
     {
-        std::cerr << error.message() << std::endl;
-        return error.code();
+        std::cerr << "failed to create " << options.export_name << std::endl;
+        return 1;
     }
 
+    window.SetUserPointer(&context);
+    window.SetFramebufferSizeCallback(framebuffer_size_callback);
+
     window.Show();
 
     int width, height;
     window.GetFramebufferSize(width, height);
     framebuffer_size_callback(window.GetHandle(), width, height);
 
+    input_state_t input{ .time = glfwGetTime() };
+    window.GetCursorPos(input.cursor_x, input.cursor_y);
+
+    frame_pacing_t pacing{ .present_interval = options.present_hz ? 1.0 / options.present_hz : 0.0 };
+    auto idle = false;
+
+    debug_keys_t keys;
+    edit_latency_t latency;
+
     while (!window.ShouldClose())
     {
-        glfwPollEvents();
+        // with every sample in, nothing changes until input arrives
+        if (idle)
+            glfwWaitEventsTimeout(0.1);
+        else
+            glfwPollEvents();
 
-        context.compute_program.Bind();
+        if (update_camera(window, input, camera))
+        {
+            set_camera(context, camera_view(camera), camera.position);
+            reproject_accumulation(context);
+            pacing.present_due = true;
+        }
 
-        context.data_buffer.Data(
-            &context.data,
-            sizeof(uniform_data_t),
-            GL_STATIC_DRAW);
+        if (const auto time = glfwGetTime(); editable && edit_scene(window, camera, edit, scene))
+        {
+            latency.upload.Counter();
+            latency.time = time;
+            latency.pending = true;
+
+            if (upload_edits(context, scene, error); error)
+            {
+                std::cerr << error.message() << std::endl;
+                return error.code();
+            }
+
+            pacing.present_due = true;
+        }
+
+        if (context.debug_counters && debug_keys(window, options, keys, context))
+            pacing.present_due = true;
 
-        auto tile_count = (vec2u(context.data.extent.swizzle<0, 1>()) + context.data.tile_extent - 1u)
-                          / context.data.tile_extent;
-        auto total_tile_count = tile_count[0] * tile_count[1];
-        auto sample_index = context.data.frame / total_tile_count;
+        pace_frame(pacing);
+        const auto rendered = dispatch_frame(context);
+        submit_frame(pacing);
 
-        context.data.frame++;
+        // the last sample still has to reach the screen before the loop goes idle
+        if (!rendered && !idle)
+            pacing.present_due = true;
+        idle = !rendered;
 
-        if (sample_index < context.data.extent[2])
+        // compute runs back to back; the display only follows at the configured rate or on demand
+        if (const auto time = glfwGetTime();
+            pacing.present_due || (!idle && time - pacing.last_present >= pacing.present_interval))
         {
-            auto groups = (context.data.tile_extent + 7u) / 8u;
+            {
+                const trace_zone_t zone("present");
+                draw_accumulation(context);
 
-            glDispatchCompute(
-                groups[0],
-                groups[1],
-                1);
-            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-        }
+                // the frame goes out as shown; the copy is collected once the gpu is done with it
+                queue_export(context, frame_export);
+                window.SwapBuffers();
+
+                if (latency.pending)
+                    report_edit_latency(latency);
+            }
 
-        context.vertex_array.Bind();
-        context.draw_program.Bind();
+            pacing.present_due = false;
+            pacing.last_present = time;
 
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+            // the trace covers load to the first whole sample on screen
+            if (trace_enabled() && context.data.frame >= tile_count(context))
+                end_trace(options);
+        }
 
-        window.SwapBuffers();
+        publish_exports(frame_export);
     }
+
+    close_export(frame_export);
+
+    if (context.debug_counters)
+        write_counters(options, context);
 }
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <array>
 #include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <utility>
 #include <vector>
+#include <glrt/jobs.hxx>
+#include <glrt/kernel.hxx>
 #include <glrt/model.hxx>
 #include <glrt/obj.hxx>
+#include <glrt/trace.hxx>
 #include <glrt/types.hxx>
 
 static std::vector<std::string_view> split(const std::string_view line, const std::string_view str)
@@ -26,7 +33,7 @@ static std::vector<std::string_view> split(const std::string_view line, const st
 template<typename T>
 static T from_string(const std::string_view str)
 {
-    T value;
+    T value{};
     std::from_chars(str.data(), str.data() + str.size(), value);
     return value;
 }
@@ -38,6 +45,7 @@ bool material_t::is_emissive() const
 
 void model_t::clear()
 {
+    material_map.clear();
     indices.clear();
     vertices.clear();
     materials.clear();
@@ -46,202 +54,403 @@ void model_t::clear()
 model_t &model_t::operator+=(const model_t &other)
 {
     const auto vertex_count = vertices.size();
-    const auto material_count = materials.size();
 
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+
+    std::pmr::vector<std::uint32_t> remap(&arena);
+    merge_materials(other, remap);
+
+    indices.reserve(indices.size() + other.indices.size());
     for (auto &index : other.indices)
         indices.emplace_back(index + vertex_count);
 
+    vertices.reserve(vertices.size() + other.vertices.size());
     for (auto &vertex : other.vertices)
-        vertices.emplace_back(vertex).material += material_count;
-
-    materials.insert(
-        materials.end(),
-        other.materials.begin(),
-        other.materials.end());
+    {
+        if (auto &v = vertices.emplace_back(vertex); v.material < remap.size())
+            v.material = remap[v.material];
+    }
 
     return *this;
 }
 
-model_t operator*(const mat4f &lhs, const model_t &rhs)
+void model_t::merge_materials(const model_t &other, std::pmr::vector<std::uint32_t> &remap)
 {
-    std::vector<vertex_t> vertices;
+    std::pmr::vector<const std::string *> names(other.materials.size(), nullptr, remap.get_allocator());
+    for (auto &[name, index] : other.material_map)
+        if (index < names.size())
+            names[index] = &name;
+
+    materials.reserve(materials.size() + other.materials.size());
 
-    const auto n_lhs = inverse(transpose(static_cast<mat3f>(lhs)));
+    remap.resize(other.materials.size());
+    for (std::uint32_t i = 0; i < other.materials.size(); ++i)
+    {
+        auto &material = other.materials[i];
 
-    for (const auto &v : rhs.vertices)
-        vertices.push_back(
+        if (!names[i])
+        {
+            remap[i] = materials.size();
+            materials.push_back(material);
+            continue;
+        }
+
+        auto name = *names[i];
+        if (auto it = material_map.find(name); it != material_map.end())
+        {
+            if (materials[it->second] == material)
             {
-                .position = lhs * v.position,
-                .normal = normalize(n_lhs * v.normal),
-                .texture = v.texture,
-                .material = v.material,
-            });
+                remap[i] = it->second;
+                continue;
+            }
+
+            name += '#' + std::to_string(materials.size());
+        }
+
+        remap[i] = materials.size();
+        material_map.emplace(std::move(name), remap[i]);
+        materials.push_back(material);
+    }
+}
+
+model_t operator*(const mat4f &lhs, const model_t &rhs)
+{
+    auto vertices = rhs.vertices;
+    transform_vertices(lhs, vertices.data(), vertices.size());
 
     return {
+        .material_map = rhs.material_map,
         .indices = rhs.indices,
         .vertices = std::move(vertices),
         .materials = rhs.materials,
     };
 }
 
-void read_obj(const std::filesystem::path &path, model_t &model)
+// lines are grouped in fixed chunks, never by thread count, so the output does not depend on scheduling
+static constexpr std::size_t OBJ_CHUNK_LINES = 4096;
+static constexpr std::size_t MTL_GRAIN = 16;
+
+enum obj_line_t : std::uint8_t
+{
+    OBJ_SKIP,
+    OBJ_POSITION,
+    OBJ_NORMAL,
+    OBJ_TEXTURE,
+    OBJ_FACE,
+    OBJ_MTLLIB,
+    OBJ_USEMTL,
+};
+
+// per-chunk counts become output offsets after an exclusive prefix sum
+struct obj_chunk_t
+{
+    std::size_t positions{};
+    std::size_t normals{};
+    std::size_t textures{};
+    std::size_t vertices{};
+    std::size_t indices{};
+
+    std::uint32_t material{};
+    std::vector<std::size_t> directives;
+    std::vector<std::uint32_t> directive_materials;
+};
+
+static bool read_file(const std::filesystem::path &path, std::string &text)
 {
-    std::vector<vec3f> vertex_positions;
-    std::vector<vec3f> vertex_normals;
-    std::vector<vec2f> vertex_textures;
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return false;
 
-    std::uint32_t material_index;
+    text.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    return true;
+}
 
-    std::ifstream stream(path);
-    if (!stream)
-        return;
+static std::vector<std::string_view> split_lines(const std::string_view text)
+{
+    std::vector<std::string_view> lines;
 
-    for (std::string line; std::getline(stream, line);)
+    std::size_t beg = 0;
+    while (beg < text.size())
     {
-        if (line.empty() || line.starts_with('#'))
-            continue;
+        auto end = text.find('\n', beg);
+        if (end == std::string_view::npos)
+            end = text.size();
 
-        auto parts = split(line, " ");
-        if (parts.empty() || parts.front() == "#")
-            continue;
+        lines.push_back(text.substr(beg, end - beg));
+        beg = end + 1;
+    }
 
-        if (parts.front() == "mtllib")
-        {
-            std::filesystem::path libpath = parts.at(1);
+    return lines;
+}
 
-            if (libpath.is_relative())
-                libpath = path.parent_path() / libpath;
+static obj_line_t classify_obj_line(const std::string_view line)
+{
+    if (line.empty() || line.starts_with('#'))
+        return OBJ_SKIP;
+
+    const auto keyword = line.substr(0, line.find(' '));
+    if (keyword == "v")
+        return OBJ_POSITION;
+    if (keyword == "vn")
+        return OBJ_NORMAL;
+    if (keyword == "vt")
+        return OBJ_TEXTURE;
+    if (keyword == "f")
+        return OBJ_FACE;
+    if (keyword == "mtllib")
+        return OBJ_MTLLIB;
+    if (keyword == "usemtl")
+        return OBJ_USEMTL;
+    return OBJ_SKIP;
+}
 
-            read_mtl(libpath, model);
-            continue;
-        }
+// 1-based or, relative to the attributes read so far, negative; false leaves the vertex attribute at its default
+static bool resolve_obj_index(const std::string_view str, const std::size_t seen, std::size_t &index)
+{
+    const auto value = from_string<std::int32_t>(str);
 
-        if (parts.front() == "usemtl")
-        {
-            auto name = parts.at(1);
-            material_index = model.material_map[std::string(name)];
-            continue;
-        }
+    if (value > 0 && static_cast<std::size_t>(value) <= seen)
+    {
+        index = value - 1;
+        return true;
+    }
+
+    if (value < 0 && static_cast<std::size_t>(-static_cast<std::int64_t>(value)) <= seen)
+    {
+        index = seen + value;
+        return true;
+    }
+
+    return false;
+}
+
+void read_obj(const std::filesystem::path &path, model_t &model)
+{
+    const trace_zone_t zone("read_obj");
+
+    std::string text;
+    if (!read_file(path, text))
+        return;
+
+    const auto lines = split_lines(text);
+    const auto chunk_count = (lines.size() + OBJ_CHUNK_LINES - 1) / OBJ_CHUNK_LINES;
 
-        if (parts.front() == "f")
+    std::vector<obj_line_t> kinds(lines.size());
+    std::vector<obj_chunk_t> chunks(chunk_count);
+
+    jobs().parallel_for(
+        0,
+        chunk_count,
+        1,
+        [&](const std::size_t begin, const std::size_t end)
         {
-            const auto first_index = model.vertices.size();
+            const trace_zone_t zone("read_obj classify");
 
-            for (std::size_t i = 1; i < parts.size(); ++i)
+            for (auto c = begin; c < end; ++c)
             {
-                auto segments = split(parts[i], "/");
-
-                auto &vertex = model.vertices.emplace_back();
-                vertex.material = material_index;
+                auto &chunk = chunks[c];
 
-                std::int32_t index;
-                switch (segments.size())
+                for (auto l = c * OBJ_CHUNK_LINES; l < std::min((c + 1) * OBJ_CHUNK_LINES, lines.size()); ++l)
                 {
-                case 1:
-                    index = from_string<std::int16_t>(segments.at(0));
-                    if (index > 0)
-                        vertex.position = vertex_positions.at(index - 1);
-                    else if (index < 0)
-                        vertex.position = vertex_positions.at(vertex_positions.size() + index);
-                    break;
-
-                case 2:
-                    index = from_string<std::int16_t>(segments.at(0));
-                    if (index > 0)
-                        vertex.position = vertex_positions.at(index - 1);
-                    else if (index < 0)
-                        vertex.position = vertex_positions.at(vertex_positions.size() + index);
-
-                    index = from_string<std::int16_t>(segments.at(1));
-                    if (index > 0)
-                        vertex.texture = vertex_textures.at(index - 1);
-                    else if (index < 0)
-                        vertex.texture = vertex_textures.at(vertex_textures.size() + index);
-                    break;
-
-                case 3:
-                    index = from_string<std::int16_t>(segments.at(0));
-                    if (index > 0)
-                        vertex.position = vertex_positions.at(index - 1);
-                    else if (index < 0)
-                        vertex.position = vertex_positions.at(vertex_positions.size() + index);
-
-                    if (!segments.at(1).empty())
+                    switch (kinds[l] = classify_obj_line(lines[l]))
                     {
-                        index = from_string<std::int16_t>(segments.at(1));
-                        if (index > 0)
-                            vertex.texture = vertex_textures.at(index - 1);
-                        else if (index < 0)
-                            vertex.texture = vertex_textures.at(vertex_textures.size() + index);
+                    case OBJ_POSITION:
+                        ++chunk.positions;
+                        break;
+                    case OBJ_NORMAL:
+                        ++chunk.normals;
+                        break;
+                    case OBJ_TEXTURE:
+                        ++chunk.textures;
+                        break;
+                    case OBJ_FACE:
+                    {
+                        const auto vertex_count = split(lines[l], " ").size() - 1;
+                        chunk.vertices += vertex_count;
+                        chunk.indices += vertex_count > 2 ? (vertex_count - 2) * 3 : 0;
+                        break;
+                    }
+                    case OBJ_MTLLIB:
+                    case OBJ_USEMTL:
+                        chunk.directives.push_back(l);
+                        break;
+                    default:
+                        break;
                     }
-
-                    index = from_string<std::int16_t>(segments.at(2));
-                    if (index > 0)
-                        vertex.normal = vertex_normals.at(index - 1);
-                    else if (index < 0)
-                        vertex.normal = vertex_normals.at(vertex_normals.size() + index);
-                    break;
-
-                default:
-                    break;
                 }
             }
+        });
 
-            const auto vertex_count = parts.size() - 1;
+    // material libraries load and names resolve in file order, exactly as one pass over the lines would
+    const auto vertex_base = model.vertices.size();
+    const auto index_base = model.indices.size();
 
-            for (std::size_t i = 1; i + 1 < vertex_count; ++i)
+    std::size_t positions = 0, normals = 0, textures = 0, vertices = vertex_base, indices = index_base;
+    std::uint32_t material_index = 0;
+
+    for (auto &chunk : chunks)
+    {
+        chunk.material = material_index;
+
+        for (const auto l : chunk.directives)
+        {
+            const auto parts = split(lines[l], " ");
+
+            if (kinds[l] == OBJ_MTLLIB)
             {
-                model.indices.push_back(first_index);
-                model.indices.push_back(first_index + i);
-                model.indices.push_back(first_index + i + 1);
+                std::filesystem::path libpath = parts.at(1);
+
+                if (libpath.is_relative())
+                    libpath = path.parent_path() / libpath;
+
+                read_mtl(libpath, model);
+                continue;
             }
 
-            continue;
+            material_index = model.material_map[std::string(parts.at(1))];
+            chunk.directive_materials.push_back(material_index);
         }
 
-        if (parts.front() == "v")
-        {
-            auto &p = vertex_positions.emplace_back();
-            p[0] = from_string<float>(parts.at(1));
-            p[1] = from_string<float>(parts.at(2));
-            p[2] = from_string<float>(parts.at(3));
+        positions += std::exchange(chunk.positions, positions);
+        normals += std::exchange(chunk.normals, normals);
+        textures += std::exchange(chunk.textures, textures);
+        vertices += std::exchange(chunk.vertices, vertices);
+        indices += std::exchange(chunk.indices, indices);
+    }
 
-            continue;
-        }
+    std::vector<vec3f> vertex_positions(positions);
+    std::vector<vec3f> vertex_normals(normals);
+    std::vector<vec2f> vertex_textures(textures);
+
+    model.vertices.resize(vertices);
+    model.indices.resize(indices);
 
-        if (parts.front() == "vn")
+    jobs().parallel_for(
+        0,
+        chunk_count,
+        1,
+        [&](const std::size_t begin, const std::size_t end)
         {
-            auto &p = vertex_normals.emplace_back();
-            p[0] = from_string<float>(parts.at(1));
-            p[1] = from_string<float>(parts.at(2));
-            p[2] = from_string<float>(parts.at(3));
+            const trace_zone_t zone("read_obj attributes");
 
-            continue;
-        }
+            for (auto c = begin; c < end; ++c)
+            {
+                auto position = chunks[c].positions;
+                auto normal = chunks[c].normals;
+                auto texture = chunks[c].textures;
+
+                for (auto l = c * OBJ_CHUNK_LINES; l < std::min((c + 1) * OBJ_CHUNK_LINES, lines.size()); ++l)
+                {
+                    if (kinds[l] != OBJ_POSITION && kinds[l] != OBJ_NORMAL && kinds[l] != OBJ_TEXTURE)
+                        continue;
+
+                    const auto parts = split(lines[l], " ");
 
-        if (parts.front() == "vt")
+                    if (kinds[l] == OBJ_TEXTURE)
+                    {
+                        auto &p = vertex_textures[texture++];
+                        p[0] = from_string<float>(parts.at(1));
+                        p[1] = from_string<float>(parts.at(2));
+                        continue;
+                    }
+
+                    auto &p = kinds[l] == OBJ_POSITION ? vertex_positions[position++] : vertex_normals[normal++];
+                    p[0] = from_string<float>(parts.at(1));
+                    p[1] = from_string<float>(parts.at(2));
+                    p[2] = from_string<float>(parts.at(3));
+                }
+            }
+        });
+
+    // faces go last: with every attribute in place, a chunk only needs its own offsets to resolve indices
+    jobs().parallel_for(
+        0,
+        chunk_count,
+        1,
+        [&](const std::size_t begin, const std::size_t end)
         {
-            auto &p = vertex_textures.emplace_back();
-            p[0] = from_string<float>(parts.at(1));
-            p[1] = from_string<float>(parts.at(2));
+            const trace_zone_t zone("read_obj faces");
 
-            continue;
-        }
+            for (auto c = begin; c < end; ++c)
+            {
+                auto &chunk = chunks[c];
 
-        // std::cerr << line << std::endl;
-    }
-}
+                auto positions_seen = chunk.positions;
+                auto normals_seen = chunk.normals;
+                auto textures_seen = chunk.textures;
+                auto vertex = chunk.vertices;
+                auto index = chunk.indices;
+                auto material = chunk.material;
+                auto directive_material = chunk.directive_materials.begin();
 
-void read_mtl(const std::filesystem::path &path, model_t &model)
-{
-    std::ifstream stream(path);
-    if (!stream)
-        return;
+                for (auto l = c * OBJ_CHUNK_LINES; l < std::min((c + 1) * OBJ_CHUNK_LINES, lines.size()); ++l)
+                {
+                    switch (kinds[l])
+                    {
+                    case OBJ_POSITION:
+                        ++positions_seen;
+                        continue;
+                    case OBJ_NORMAL:
+                        ++normals_seen;
+                        continue;
+                    case OBJ_TEXTURE:
+                        ++textures_seen;
+                        continue;
+                    case OBJ_USEMTL:
+                        material = *directive_material++;
+                        continue;
+                    case OBJ_FACE:
+                        break;
+                    default:
+                        continue;
+                    }
 
-    material_t *material{};
+                    const auto parts = split(lines[l], " ");
+                    const auto first_index = vertex;
 
-    for (std::string line; std::getline(stream, line);)
+                    for (std::size_t i = 1; i < parts.size(); ++i)
+                    {
+                        const auto segments = split(parts[i], "/");
+
+                        auto &v = model.vertices[vertex++];
+                        v.material = material;
+
+                        if (segments.empty() || segments.size() > 3)
+                            continue;
+
+                        std::size_t a;
+                        if (resolve_obj_index(segments[0], positions_seen, a))
+                            v.position = vertex_positions[a];
+
+                        if (segments.size() > 1 && !segments[1].empty()
+                            && resolve_obj_index(segments[1], textures_seen, a))
+                            v.texture = vertex_textures[a];
+
+                        if (segments.size() > 2 && resolve_obj_index(segments[2], normals_seen, a))
+                            v.normal = vertex_normals[a];
+                    }
+
+                    for (std::size_t i = 1; i + 1 < parts.size() - 1; ++i)
+                    {
+                        model.indices[index++] = first_index;
+                        model.indices[index++] = first_index + i;
+                        model.indices[index++] = first_index + i + 1;
+                    }
+                }
+            }
+        });
+}
+
+static void read_mtl_block(
+    const std::vector<std::string_view> &lines,
+    std::size_t begin,
+    const std::size_t end,
+    material_t &material)
+{
+    for (++begin; begin < end; ++begin)
     {
+        const auto line = lines[begin];
         if (line.empty() || line.starts_with('#'))
             continue;
 
@@ -249,61 +458,85 @@ void read_mtl(const std::filesystem::path &path, model_t &model)
         if (parts.empty() || parts.front() == "#")
             continue;
 
-        if (parts.front() == "newmtl")
-        {
-            auto name = parts.at(1);
-            model.material_map.emplace(name, model.materials.size());
-            material = &model.materials.emplace_back();
-            continue;
-        }
-
-        if (!material)
-            continue;
-
         if (parts.front() == "Kd")
         {
-            material->albedo[0] = from_string<float>(parts.at(1));
-            material->albedo[1] = from_string<float>(parts.at(2));
-            material->albedo[2] = from_string<float>(parts.at(3));
+            material.albedo[0] = from_string<float>(parts.at(1));
+            material.albedo[1] = from_string<float>(parts.at(2));
+            material.albedo[2] = from_string<float>(parts.at(3));
             continue;
         }
 
         if (parts.front() == "Ke")
         {
-            material->emission[0] = from_string<float>(parts.at(1));
-            material->emission[1] = from_string<float>(parts.at(2));
-            material->emission[2] = from_string<float>(parts.at(3));
+            material.emission[0] = from_string<float>(parts.at(1));
+            material.emission[1] = from_string<float>(parts.at(2));
+            material.emission[2] = from_string<float>(parts.at(3));
             continue;
         }
 
         if (parts.front() == "Pr")
         {
-            material->roughness = from_string<float>(parts.at(1));
+            material.roughness = from_string<float>(parts.at(1));
             continue;
         }
 
         if (parts.front() == "Pm")
         {
-            material->metallic = from_string<float>(parts.at(1));
+            material.metallic = from_string<float>(parts.at(1));
             continue;
         }
 
         if (parts.front() == "Ps")
         {
-            material->sheen = from_string<float>(parts.at(1));
+            material.sheen = from_string<float>(parts.at(1));
             continue;
         }
 
         if (parts.front() == "Pc")
         {
-            material->clearcoat_thickness = from_string<float>(parts.at(1));
+            material.clearcoat_thickness = from_string<float>(parts.at(1));
             continue;
         }
 
         if (parts.front() == "Pcr")
         {
-            material->clearcoat_roughness = from_string<float>(parts.at(1));
+            material.clearcoat_roughness = from_string<float>(parts.at(1));
             continue;
         }
     }
 }
+
+void read_mtl(const std::filesystem::path &path, model_t &model)
+{
+    const trace_zone_t zone("read_mtl");
+
+    std::string text;
+    if (!read_file(path, text))
+        return;
+
+    const auto lines = split_lines(text);
+
+    // each newmtl opens a block running to the next one; blocks parse independently
+    std::vector<std::size_t> blocks;
+    for (std::size_t l = 0; l < lines.size(); ++l)
+        if (lines[l].starts_with("newmtl "))
+            blocks.push_back(l);
+    blocks.push_back(lines.size());
+
+    const auto block_count = blocks.size() - 1;
+    const auto first_material = model.materials.size();
+    model.materials.resize(first_material + block_count);
+
+    jobs().parallel_for(
+        0,
+        block_count,
+        MTL_GRAIN,
+        [&](const std::size_t begin, const std::size_t end)
+        {
+            for (auto b = begin; b < end; ++b)
+                read_mtl_block(lines, blocks[b], blocks[b + 1], model.materials[first_material + b]);
+        });
+
+    for (std::size_t b = 0; b < block_count; ++b)
+        model.material_map.emplace(split(lines[blocks[b]], " ").at(1), first_material + b);
+}
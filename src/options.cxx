@@ -0,0 +1,200 @@
+#include <charconv>
+#include <iostream>
+#include <string_view>
+#include <glrt/options.hxx>
+
+static void print_usage(const std::string_view program)
+{
+    std::cerr
+            << "usage: " << program << " [options]\n"
+            << "  --scene <path>            .obj or .glb file to render (default the built-in cornell box)\n"
+            << "  --environment <path>      .hdr or .pfm equirectangular map lighting the scene (default analytic sky)\n"
+            << "  --size <width>x<height>   image size (default 600x600)\n"
+            << "  --samples <n>             samples per pixel (default 1600)\n"
+            << "  --spatial-splits <pct>    spatial split reference budget, % of triangles (default 0, off)\n"
+            << "  --bvh-nodes <full|compact> node encoding uploaded to the GPU (default full)\n"
+            << "  --primary <trace|raster>  primary visibility from BVH rays or a jittered g-buffer (default trace)\n"
+            << "  --direct <nee|restir>     direct light from one light sample per bounce or resampled reservoirs (default nee)\n"
+            << "  --present-hz <n>          display refresh while compute runs back to back, 0 presents every tile (default 60)\n"
+            << "  --threads <n>             host threads for scene loading and bvh setup (default 0, one per core)\n"
+            << "  --page-budget <MiB>       stream geometry pages through a cache of this size (default 0, off)\n"
+            << "  --page-file <path>        keep the pages here and render from them later without loading the scene\n"
+            << "                            (default a per-process file under cache/, removed once open)\n"
+            << "  --worker <host:port>      render work units for a coordinator\n"
+            << "  --coordinator <port>      distribute tiles to worker processes\n"
+            << "  --workers <n>             remote workers to wait for before starting\n"
+            << "  --local-workers <n>       worker processes to spawn on this machine\n"
+            << "  --unit-samples <n>        samples per work unit (default 16)\n"
+            << "  --output <path>           coordinator output image (default output.pfm)\n"
+            << "  --benchmark <ref.pfm>     render headless and log error against a reference, or write it if missing\n"
+            << "  --benchmark-suite <dir>   benchmark the built-in scenes at 512x512 against <dir>/<scene>.pfm, writing\n"
+            << "                            missing references and a <dir>/<scene>.csv curve per scene\n"
+            << "                            (asset/benchmark holds the checked-in references)\n"
+            << "  --trace <path>            write chrome trace-event json of startup up to the first whole sample\n"
+            << "  --debug-counters <prefix> count traversal work per pixel: v cycles heatmaps, c and exit write <prefix>_*.pfm\n"
+            << "                            (with --primary raster the g-buffer replaces primary rays, which are not counted)\n"
+            << "  --export <name>           publish presented frames to the posix shared-memory ring /<name>\n"
+            << "  --export-format <ldr|raw> tonemapped rgba8 or accumulated rgba32f with sample counts (default ldr)\n"
+            << "  --curve <path>            benchmark convergence csv (default convergence.csv)\n";
+}
+
+static bool parse_uint(const std::string_view str, std::uint32_t &value)
+{
+    const auto end = str.data() + str.size();
+    const auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+bool parse_options(const int argc, const char *const *argv, options_t &options)
+{
+    const std::string_view program = argc ? argv[0] : "glrt";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+
+        if (arg == "--help")
+        {
+            print_usage(program);
+            return false;
+        }
+
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            print_usage(program);
+            return false;
+        }
+
+        const std::string_view value = argv[++i];
+
+        auto ok = true;
+        if (arg == "--scene")
+            options.scene = value;
+        else if (arg == "--environment")
+            options.environment = value;
+        else if (arg == "--size")
+        {
+            const auto x = value.find('x');
+            ok = x != std::string_view::npos
+                 && parse_uint(value.substr(0, x), options.width)
+                 && parse_uint(value.substr(x + 1), options.height)
+                 && options.width && options.height;
+        }
+        else if (arg == "--samples")
+            ok = parse_uint(value, options.samples) && options.samples;
+        else if (arg == "--spatial-splits")
+            ok = parse_uint(value, options.split_budget);
+        else if (arg == "--bvh-nodes")
+        {
+            ok = value == "full" || value == "compact";
+            options.compact_nodes = value == "compact";
+        }
+        else if (arg == "--primary")
+        {
+            ok = value == "trace" || value == "raster";
+            options.raster_primary = value == "raster";
+        }
+        else if (arg == "--direct")
+        {
+            ok = value == "nee" || value == "restir";
+            options.restir = value == "restir";
+        }
+        else if (arg == "--present-hz")
+            ok = parse_uint(value, options.present_hz);
+        else if (arg == "--threads")
+            ok = parse_uint(value, options.threads);
+        else if (arg == "--page-budget")
+            ok = parse_uint(value, options.page_budget);
+        else if (arg == "--page-file")
+            ok = !(options.page_file = value).empty();
+        else if (arg == "--worker")
+        {
+            options.mode = MODE_WORKER;
+            options.address = value;
+        }
+        else if (arg == "--coordinator")
+        {
+            options.mode = MODE_COORDINATOR;
+            options.address = value;
+        }
+        else if (arg == "--workers")
+            ok = parse_uint(value, options.workers);
+        else if (arg == "--local-workers")
+            ok = parse_uint(value, options.local_workers);
+        else if (arg == "--unit-samples")
+            ok = parse_uint(value, options.unit_samples) && options.unit_samples;
+        else if (arg == "--output")
+            options.output = value;
+        else if (arg == "--benchmark")
+        {
+            options.mode = MODE_BENCHMARK;
+            options.reference = value;
+        }
+        else if (arg == "--benchmark-suite")
+        {
+            options.mode = MODE_BENCHMARK_SUITE;
+            options.reference = value;
+        }
+        else if (arg == "--trace")
+            options.trace = value;
+        else if (arg == "--debug-counters")
+            options.debug_counters = value;
+        else if (arg == "--export")
+        {
+            ok = !value.empty() && value.find('/') == std::string_view::npos;
+            options.export_name = "/" + std::string(value);
+        }
+        else if (arg == "--export-format")
+        {
+            ok = value == "ldr" || value == "raw";
+            options.export_raw = value == "raw";
+        }
+        else if (arg == "--curve")
+            options.curve = value;
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            print_usage(program);
+            return false;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "invalid value '" << value << "' for " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.page_budget && (options.compact_nodes || options.raster_primary))
+    {
+        std::cerr << "--page-budget needs --bvh-nodes full and --primary trace" << std::endl;
+        return false;
+    }
+
+    if (options.restir && (options.page_budget || options.mode == MODE_WORKER || options.mode == MODE_COORDINATOR))
+    {
+        std::cerr << "--direct restir needs whole frames in memory: no --page-budget, no distributed rendering" << std::endl;
+        return false;
+    }
+
+    if (!options.debug_counters.empty() && (options.mode == MODE_WORKER || options.mode == MODE_COORDINATOR))
+    {
+        std::cerr << "--debug-counters needs whole frames in memory: no distributed rendering" << std::endl;
+        return false;
+    }
+
+    if (!options.export_name.empty() && options.mode != MODE_INTERACTIVE)
+    {
+        std::cerr << "--export follows the interactive loop's presented frames" << std::endl;
+        return false;
+    }
+
+    if (options.mode == MODE_COORDINATOR && !options.workers && !options.local_workers)
+    {
+        std::cerr << "coordinator needs --workers or --local-workers" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <glrt/paging.hxx>
+#include <glrt/trace.hxx>
+
+static bool is_leaf(const bvh_node_t &node)
+{
+    return node.begin != node.end || node.left == 0xffffffffu;
+}
+
+static std::uint32_t count_triangles(
+    const std::vector<bvh_node_t> &nodes,
+    const std::uint32_t index,
+    std::vector<std::uint32_t> &counts)
+{
+    const auto &node = nodes[index];
+
+    if (is_leaf(node))
+        return counts[index] = node.end - node.begin;
+
+    return counts[index] = count_triangles(nodes, node.left, counts) + count_triangles(nodes, node.right, counts);
+}
+
+static std::uint32_t copy_treelet(
+    const model_t &model,
+    const bvh_t &tree,
+    const std::uint32_t index,
+    page_t &page)
+{
+    const auto &node = tree.nodes[index];
+    const auto local = page.header.node_count++;
+
+    if (is_leaf(node))
+    {
+        const auto begin = page.header.triangle_count;
+        for (auto i = node.begin; i < node.end; ++i)
+        {
+            for (std::uint32_t k = 0; k < 3; ++k)
+                page.vertices[page.header.triangle_count * 3 + k] = model.vertices[model.indices[tree.map[i] + k]];
+            page.header.triangle_count++;
+        }
+
+        page.nodes[local] = {
+            .box_min = node.box_min,
+            .box_max = node.box_max,
+            .left = 0xffffffffu,
+            .right = 0xffffffffu,
+            .begin = begin,
+            .end = page.header.triangle_count,
+        };
+        return local;
+    }
+
+    const auto left = copy_treelet(model, tree, node.left, page);
+    const auto right = copy_treelet(model, tree, node.right, page);
+
+    page.nodes[local] = {
+        .box_min = node.box_min,
+        .box_max = node.box_max,
+        .left = left,
+        .right = right,
+        .begin = 0xffffffffu,
+        .end = 0xffffffffu,
+    };
+    return local;
+}
+
+static std::uint32_t build_top_level(
+    const model_t &model,
+    const bvh_t &tree,
+    const std::vector<std::uint32_t> &counts,
+    const std::uint32_t index,
+    std::vector<bvh_node_t> &top,
+    page_t &page,
+    std::uint32_t &page_count,
+    std::ofstream &stream)
+{
+    const auto &node = tree.nodes[index];
+    const auto top_index = static_cast<std::uint32_t>(top.size());
+    top.emplace_back();
+
+    if (counts[index] <= PAGE_TRIANGLES)
+    {
+        page.header = {};
+        copy_treelet(model, tree, index, page);
+        stream.write(reinterpret_cast<const char *>(&page), sizeof(page_t));
+
+        top[top_index] = {
+            .box_min = node.box_min,
+            .box_max = node.box_max,
+            .left = 0xffffffffu,
+            .right = 0xffffffffu,
+            .begin = page_count,
+            .end = page_count + 1,
+        };
+        page_count++;
+        return top_index;
+    }
+
+    const auto left = build_top_level(model, tree, counts, node.left, top, page, page_count, stream);
+    const auto right = build_top_level(model, tree, counts, node.right, top, page, page_count, stream);
+
+    top[top_index] = {
+        .box_min = node.box_min,
+        .box_max = node.box_max,
+        .left = left,
+        .right = right,
+        .begin = 0xffffffffu,
+        .end = 0xffffffffu,
+    };
+    return top_index;
+}
+
+template<typename T>
+static void write_array(std::ofstream &stream, const std::vector<T> &data)
+{
+    const std::uint64_t count = data.size();
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+// counts come from the file; anything past its end is a corrupt file, not an allocation to attempt
+template<typename T>
+static bool read_array(std::ifstream &stream, const std::uint64_t limit, std::vector<T> &data)
+{
+    std::uint64_t count{};
+    if (!stream.read(reinterpret_cast<char *>(&count), sizeof(count)))
+        return false;
+
+    const auto position = static_cast<std::uint64_t>(stream.tellg());
+    if (count > (limit - std::min(position, limit)) / sizeof(T))
+        return false;
+
+    data.resize(count);
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+static void write_resident(std::ofstream &stream, const model_t &model, const bvh_t &tree)
+{
+    write_array(stream, tree.nodes);
+    write_array(stream, tree.lights);
+    write_array(stream, tree.light_areas);
+    stream.write(reinterpret_cast<const char *>(&tree.total_light_area), sizeof(tree.total_light_area));
+
+    write_array(stream, model.indices);
+    write_array(stream, model.vertices);
+    write_array(stream, model.materials);
+
+    const std::uint64_t names = model.material_map.size();
+    stream.write(reinterpret_cast<const char *>(&names), sizeof(names));
+    for (const auto &[name, index] : model.material_map)
+    {
+        write_array(stream, std::vector<char>(name.begin(), name.end()));
+        stream.write(reinterpret_cast<const char *>(&index), sizeof(index));
+    }
+}
+
+static bool read_resident(std::ifstream &stream, const std::uint64_t limit, model_t &model, bvh_t &tree)
+{
+    if (!read_array(stream, limit, tree.nodes)
+        || !read_array(stream, limit, tree.lights)
+        || !read_array(stream, limit, tree.light_areas)
+        || !stream.read(reinterpret_cast<char *>(&tree.total_light_area), sizeof(tree.total_light_area))
+        || !read_array(stream, limit, model.indices)
+        || !read_array(stream, limit, model.vertices)
+        || !read_array(stream, limit, model.materials))
+        return false;
+
+    std::uint64_t names{};
+    if (!stream.read(reinterpret_cast<char *>(&names), sizeof(names)))
+        return false;
+
+    std::vector<char> name;
+    for (std::uint64_t i = 0; i < names; ++i)
+    {
+        std::uint32_t index{};
+        if (!read_array(stream, limit, name) || !stream.read(reinterpret_cast<char *>(&index), sizeof(index)))
+            return false;
+        if (index >= model.materials.size())
+            return false;
+
+        model.material_map.emplace(std::string(name.begin(), name.end()), index);
+    }
+
+    return true;
+}
+
+bool page_bvh(
+    model_t &model,
+    bvh_t &tree,
+    const std::filesystem::path &path,
+    const std::uint64_t key,
+    std::uint32_t &page_count)
+{
+    const trace_zone_t zone("page_bvh");
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::ofstream stream(path, std::ofstream::binary | std::ofstream::trunc);
+    if (!stream)
+        return false;
+
+    std::vector<std::uint32_t> counts(tree.nodes.size());
+    count_triangles(tree.nodes, 0, counts);
+
+    const auto page = std::make_unique<page_t>();
+    std::vector<bvh_node_t> top;
+
+    page_count = 0;
+    build_top_level(model, tree, counts, 0, top, *page, page_count, stream);
+
+    model_t lights;
+    lights.material_map = std::move(model.material_map);
+    lights.materials = std::move(model.materials);
+
+    for (std::uint32_t i = 0; i < tree.lights.size(); ++i)
+    {
+        for (std::uint32_t k = 0; k < 3; ++k)
+        {
+            lights.indices.push_back(i * 3 + k);
+            lights.vertices.push_back(model.vertices[model.indices[tree.lights[i] + k]]);
+        }
+        tree.lights[i] = i * 3;
+    }
+
+    model = std::move(lights);
+
+    tree.nodes = std::move(top);
+    tree.compact_nodes.clear();
+    tree.map.clear();
+    tree.map.shrink_to_fit();
+
+    const page_file_trailer_t trailer
+    {
+        .magic = PAGE_FILE_MAGIC,
+        .key = key,
+        .resident_offset = static_cast<std::uint64_t>(page_count) * sizeof(page_t),
+        .page_count = page_count,
+        .page_bytes = sizeof(page_t),
+    };
+
+    write_resident(stream, model, tree);
+    stream.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+
+    return static_cast<bool>(stream.flush());
+}
+
+bool read_paged_scene(
+    const std::filesystem::path &path,
+    const std::uint64_t key,
+    model_t &model,
+    bvh_t &tree,
+    std::uint32_t &page_count)
+{
+    const trace_zone_t zone("read_paged_scene");
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || size < sizeof(page_file_trailer_t))
+        return false;
+
+    std::ifstream stream(path, std::ifstream::binary);
+
+    const auto limit = size - sizeof(page_file_trailer_t);
+
+    page_file_trailer_t trailer;
+    stream.seekg(static_cast<std::streamoff>(limit));
+    if (!stream.read(reinterpret_cast<char *>(&trailer), sizeof(trailer)))
+        return false;
+
+    if (trailer.magic != PAGE_FILE_MAGIC
+        || trailer.key != key
+        || trailer.page_bytes != sizeof(page_t)
+        || trailer.resident_offset != static_cast<std::uint64_t>(trailer.page_count) * sizeof(page_t)
+        || trailer.resident_offset > limit)
+        return false;
+
+    stream.seekg(static_cast<std::streamoff>(trailer.resident_offset));
+
+    model.clear();
+    tree = {};
+    if (!read_resident(stream, limit, model, tree) || static_cast<std::uint64_t>(stream.tellg()) != limit)
+        return false;
+
+    page_count = trailer.page_count;
+    return true;
+}
+
+bool open_page_cache(
+    page_cache_t &cache,
+    const std::filesystem::path &path,
+    const std::uint32_t page_count,
+    const std::uint32_t slot_count)
+{
+    cache.file.open(path, std::ifstream::binary);
+    if (!cache.file)
+        return false;
+
+    cache.page_count = page_count;
+    cache.slot_count = std::min(slot_count, page_count);
+    cache.page_slots.assign(page_count, PAGE_NONE);
+    cache.slot_pages.assign(cache.slot_count, PAGE_NONE);
+    cache.slot_clock.assign(cache.slot_count, 0);
+    cache.clock = 1;
+    cache.retries = 0;
+
+    return true;
+}
+
+bool read_page(page_cache_t &cache, const std::uint32_t page, page_t &data)
+{
+    cache.file.seekg(static_cast<std::streamoff>(page) * static_cast<std::streamoff>(sizeof(page_t)));
+    cache.file.read(reinterpret_cast<char *>(&data), sizeof(page_t));
+    return static_cast<bool>(cache.file);
+}
+
+std::uint32_t evict_slot(const page_cache_t &cache)
+{
+    const auto it = std::min_element(cache.slot_clock.begin(), cache.slot_clock.end());
+    return static_cast<std::uint32_t>(it - cache.slot_clock.begin());
+}
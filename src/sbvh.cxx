@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <glrt/bvh.hxx>
+#include <glrt/kernel.hxx>
+#include <glrt/trace.hxx>
+
+constexpr unsigned SPLIT_BINS = 32;
+
+constexpr float TRAVERSAL_COST = 1.0f;
+constexpr float INTERSECTION_COST = 1.0f;
+
+// spatial splits are only tried where the best object split overlaps by more than this fraction of the root area
+constexpr float SPLIT_OVERLAP = 1e-5f;
+
+constexpr unsigned MAX_DEPTH = 48;
+
+struct split_t
+{
+    float cost = std::numeric_limits<float>::infinity();
+    unsigned axis{};
+    unsigned bin{};
+    float position{};
+    bool spatial{};
+};
+
+struct sbvh_builder_t
+{
+    const model_t &model;
+    bvh_t &tree;
+    std::size_t budget{};
+    float root_area{};
+};
+
+static unsigned centroid_bin(const triangle_t &reference, const box_t &centroid_bounds, const unsigned axis)
+{
+    const auto extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+    const auto bin = static_cast<unsigned>((reference.centroid[axis] - centroid_bounds.min[axis]) / extent * SPLIT_BINS);
+    return std::min(bin, SPLIT_BINS - 1);
+}
+
+static unsigned spatial_bin(const float value, const box_t &bounds, const unsigned axis)
+{
+    const auto extent = bounds.max[axis] - bounds.min[axis];
+    const auto bin = static_cast<int>((value - bounds.min[axis]) / extent * SPLIT_BINS);
+    return static_cast<unsigned>(std::clamp(bin, 0, static_cast<int>(SPLIT_BINS) - 1));
+}
+
+static float spatial_plane(const box_t &bounds, const unsigned axis, const unsigned bin)
+{
+    return bounds.min[axis] + (bounds.max[axis] - bounds.min[axis]) * static_cast<float>(bin) / SPLIT_BINS;
+}
+
+static triangle_t make_reference(const std::uint32_t index, const box_t &bounds)
+{
+    return {
+        .index = index,
+        .bounds = bounds,
+        .centroid = (bounds.min + bounds.max) * 0.5f,
+    };
+}
+
+// bounds of the parts of the triangle on either side of the plane, clipped to the reference bounds
+static void split_reference(
+    const model_t &model,
+    const triangle_t &reference,
+    const unsigned axis,
+    const float position,
+    box_t &left,
+    box_t &right)
+{
+    const vec3f p[3]
+    {
+        model.vertices[model.indices[reference.index + 0]].position,
+        model.vertices[model.indices[reference.index + 1]].position,
+        model.vertices[model.indices[reference.index + 2]].position,
+    };
+
+    left = box_empty();
+    right = box_empty();
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const auto &a = p[i];
+        const auto &b = p[(i + 1) % 3];
+
+        if (a[axis] <= position)
+            left = box_union(left, a);
+        if (a[axis] >= position)
+            right = box_union(right, a);
+
+        if ((a[axis] < position && b[axis] > position) || (a[axis] > position && b[axis] < position))
+        {
+            auto q = a + (b - a) * ((position - a[axis]) / (b[axis] - a[axis]));
+            q[axis] = position;
+
+            left = box_union(left, q);
+            right = box_union(right, q);
+        }
+    }
+
+    left.max[axis] = position;
+    right.min[axis] = position;
+
+    left = box_intersection(left, reference.bounds);
+    right = box_intersection(right, reference.bounds);
+}
+
+static float split_cost(const float node_area, const box_t &left, const std::size_t left_count, const box_t &right, const std::size_t right_count)
+{
+    return TRAVERSAL_COST
+           + INTERSECTION_COST * (box_area(left) * static_cast<float>(left_count) + box_area(right) * static_cast<float>(right_count))
+           / node_area;
+}
+
+static split_t find_object_split(
+    const std::vector<triangle_t> &references,
+    const box_t &centroid_bounds,
+    const float node_area,
+    box_t &overlap)
+{
+    split_t best;
+    overlap = box_empty();
+
+    for (unsigned axis = 0; axis < 3; ++axis)
+    {
+        if (centroid_bounds.max[axis] <= centroid_bounds.min[axis])
+            continue;
+
+        box_t bins[SPLIT_BINS];
+        std::size_t counts[SPLIT_BINS]{};
+        std::fill(std::begin(bins), std::end(bins), box_empty());
+
+        for (auto &reference : references)
+        {
+            const auto bin = centroid_bin(reference, centroid_bounds, axis);
+            bins[bin] = box_union(bins[bin], reference.bounds);
+            counts[bin]++;
+        }
+
+        box_t right_bounds[SPLIT_BINS];
+        right_bounds[SPLIT_BINS - 1] = bins[SPLIT_BINS - 1];
+        for (auto i = SPLIT_BINS - 1; i > 0; --i)
+            right_bounds[i - 1] = box_union(right_bounds[i], bins[i - 1]);
+
+        auto left = box_empty();
+        std::size_t left_count = 0;
+
+        for (unsigned i = 1; i < SPLIT_BINS; ++i)
+        {
+            left = box_union(left, bins[i - 1]);
+            left_count += counts[i - 1];
+
+            const auto right_count = references.size() - left_count;
+            if (!left_count || !right_count)
+                continue;
+
+            if (const auto cost = split_cost(node_area, left, left_count, right_bounds[i], right_count); cost < best.cost)
+            {
+                best = {
+                    .cost = cost,
+                    .axis = axis,
+                    .bin = i,
+                };
+                overlap = box_intersection(left, right_bounds[i]);
+            }
+        }
+    }
+
+    return best;
+}
+
+static split_t find_spatial_split(
+    const model_t &model,
+    const std::vector<triangle_t> &references,
+    const box_t &bounds,
+    const float node_area)
+{
+    split_t best;
+
+    for (unsigned axis = 0; axis < 3; ++axis)
+    {
+        if (bounds.max[axis] <= bounds.min[axis])
+            continue;
+
+        box_t bins[SPLIT_BINS];
+        std::size_t entries[SPLIT_BINS]{};
+        std::size_t exits[SPLIT_BINS]{};
+        std::fill(std::begin(bins), std::end(bins), box_empty());
+
+        for (auto &reference : references)
+        {
+            const auto first = spatial_bin(reference.bounds.min[axis], bounds, axis);
+            const auto last = std::max(first, spatial_bin(reference.bounds.max[axis], bounds, axis));
+
+            entries[first]++;
+            exits[last]++;
+
+            auto rest = reference;
+            for (auto bin = first; bin < last; ++bin)
+            {
+                box_t left, right;
+                split_reference(model, rest, axis, spatial_plane(bounds, axis, bin + 1), left, right);
+
+                bins[bin] = box_union(bins[bin], left);
+                rest.bounds = right;
+            }
+            bins[last] = box_union(bins[last], rest.bounds);
+        }
+
+        box_t right_bounds[SPLIT_BINS];
+        std::size_t right_counts[SPLIT_BINS];
+        right_bounds[SPLIT_BINS - 1] = bins[SPLIT_BINS - 1];
+        right_counts[SPLIT_BINS - 1] = exits[SPLIT_BINS - 1];
+        for (auto i = SPLIT_BINS - 1; i > 0; --i)
+        {
+            right_bounds[i - 1] = box_union(right_bounds[i], bins[i - 1]);
+            right_counts[i - 1] = right_counts[i] + exits[i - 1];
+        }
+
+        auto left = box_empty();
+        std::size_t left_count = 0;
+
+        for (unsigned i = 1; i < SPLIT_BINS; ++i)
+        {
+            left = box_union(left, bins[i - 1]);
+            left_count += entries[i - 1];
+
+            if (!left_count || !right_counts[i])
+                continue;
+
+            if (const auto cost = split_cost(node_area, left, left_count, right_bounds[i], right_counts[i]); cost < best.cost)
+            {
+                best = {
+                    .cost = cost,
+                    .axis = axis,
+                    .bin = i,
+                    .position = spatial_plane(bounds, axis, i),
+                    .spatial = true,
+                };
+            }
+        }
+    }
+
+    return best;
+}
+
+static void partition_object(
+    std::vector<triangle_t> &references,
+    const box_t &centroid_bounds,
+    const split_t &split,
+    std::vector<triangle_t> &left,
+    std::vector<triangle_t> &right)
+{
+    for (auto &reference : references)
+    {
+        if (centroid_bin(reference, centroid_bounds, split.axis) < split.bin)
+            left.push_back(reference);
+        else
+            right.push_back(reference);
+    }
+}
+
+static void partition_median(
+    std::vector<triangle_t> &references,
+    const box_t &centroid_bounds,
+    std::vector<triangle_t> &left,
+    std::vector<triangle_t> &right)
+{
+    const auto extent = centroid_bounds.max - centroid_bounds.min;
+    const auto axis = extent[0] > extent[1] && extent[0] > extent[2] ? 0 : extent[1] > extent[2] ? 1 : 2;
+
+    const auto mid = references.begin() + static_cast<std::ptrdiff_t>(references.size() / 2);
+
+    std::nth_element(
+        references.begin(),
+        mid,
+        references.end(),
+        [axis](const triangle_t &a, const triangle_t &b)
+        {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+
+    left.assign(references.begin(), mid);
+    right.assign(mid, references.end());
+}
+
+// straddling references are duplicated into both children unless moving them whole to one side is cheaper
+// (reference unsplitting) or the duplication budget is spent
+static void partition_spatial(
+    sbvh_builder_t &builder,
+    std::vector<triangle_t> &references,
+    const split_t &split,
+    std::vector<triangle_t> &left,
+    std::vector<triangle_t> &right)
+{
+    std::vector<triangle_t> straddling;
+
+    auto left_bounds = box_empty();
+    auto right_bounds = box_empty();
+
+    for (auto &reference : references)
+    {
+        if (reference.bounds.max[split.axis] <= split.position)
+        {
+            left.push_back(reference);
+            left_bounds = box_union(left_bounds, reference.bounds);
+        }
+        else if (reference.bounds.min[split.axis] >= split.position)
+        {
+            right.push_back(reference);
+            right_bounds = box_union(right_bounds, reference.bounds);
+        }
+        else
+            straddling.push_back(reference);
+    }
+
+    auto left_count = left.size() + straddling.size();
+    auto right_count = right.size() + straddling.size();
+
+    for (auto &reference : straddling)
+    {
+        box_t left_part, right_part;
+        split_reference(builder.model, reference, split.axis, split.position, left_part, right_part);
+
+        if (!box_valid(left_part) || !box_valid(right_part))
+        {
+            auto &side = box_valid(left_part) ? left : right;
+            auto &side_bounds = box_valid(left_part) ? left_bounds : right_bounds;
+            side.push_back(reference);
+            side_bounds = box_union(side_bounds, reference.bounds);
+            (box_valid(left_part) ? right_count : left_count)--;
+            continue;
+        }
+
+        const auto split_left = box_union(left_bounds, left_part);
+        const auto split_right = box_union(right_bounds, right_part);
+        const auto whole_left = box_union(left_bounds, reference.bounds);
+        const auto whole_right = box_union(right_bounds, reference.bounds);
+
+        const auto l = static_cast<float>(left_count);
+        const auto r = static_cast<float>(right_count);
+
+        const auto cost_split = builder.budget ? box_area(split_left) * l + box_area(split_right) * r : std::numeric_limits<float>::infinity();
+        const auto cost_left = box_area(whole_left) * l + box_area(right_bounds) * (r - 1.0f);
+        const auto cost_right = box_area(left_bounds) * (l - 1.0f) + box_area(whole_right) * r;
+
+        if (cost_split < cost_left && cost_split < cost_right)
+        {
+            left.push_back(make_reference(reference.index, left_part));
+            right.push_back(make_reference(reference.index, right_part));
+            left_bounds = split_left;
+            right_bounds = split_right;
+            builder.budget--;
+        }
+        else if (cost_left < cost_right)
+        {
+            left.push_back(reference);
+            left_bounds = whole_left;
+            right_count--;
+        }
+        else
+        {
+            right.push_back(reference);
+            right_bounds = whole_right;
+            left_count--;
+        }
+    }
+}
+
+static std::uint32_t build_sbvh_node(sbvh_builder_t &builder, std::vector<triangle_t> &&references, const unsigned depth)
+{
+    auto &nodes = builder.tree.nodes;
+    auto &map = builder.tree.map;
+
+    box_t bounds, centroid_bounds;
+    triangle_bounds(references.data(), references.size(), bounds, centroid_bounds);
+
+    const auto node_index = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    const auto count = references.size();
+    const auto node_area = box_area(bounds);
+
+    split_t split;
+    if (node_area > 0.0f && depth < MAX_DEPTH)
+    {
+        box_t overlap;
+        split = find_object_split(references, centroid_bounds, node_area, overlap);
+
+        if (builder.budget && box_area(overlap) > SPLIT_OVERLAP * builder.root_area)
+        {
+            if (const auto spatial = find_spatial_split(builder.model, references, bounds, node_area); spatial.cost < split.cost)
+                split = spatial;
+        }
+    }
+
+    if (count <= MAX_LEAF_TRIS && split.cost >= INTERSECTION_COST * static_cast<float>(count))
+    {
+        const auto begin = static_cast<std::uint32_t>(map.size());
+        for (auto &reference : references)
+            map.push_back(reference.index);
+
+        nodes[node_index] = {
+            .box_min = bounds.min,
+            .box_max = bounds.max,
+            .left = 0xffffffffu,
+            .right = 0xffffffffu,
+            .begin = begin,
+            .end = static_cast<std::uint32_t>(map.size()),
+        };
+        return node_index;
+    }
+
+    std::vector<triangle_t> left_references, right_references;
+    left_references.reserve(count);
+    right_references.reserve(count);
+
+    if (split.spatial)
+        partition_spatial(builder, references, split, left_references, right_references);
+    else if (split.cost < std::numeric_limits<float>::infinity())
+        partition_object(references, centroid_bounds, split, left_references, right_references);
+
+    if (left_references.empty() || right_references.empty())
+    {
+        left_references.clear();
+        right_references.clear();
+        partition_median(references, centroid_bounds, left_references, right_references);
+    }
+
+    references.clear();
+    references.shrink_to_fit();
+
+    const auto left = build_sbvh_node(builder, std::move(left_references), depth + 1);
+    const auto right = build_sbvh_node(builder, std::move(right_references), depth + 1);
+
+    nodes[node_index] = {
+        .box_min = bounds.min,
+        .box_max = bounds.max,
+        .left = left,
+        .right = right,
+        .begin = 0xffffffffu,
+        .end = 0xffffffffu,
+    };
+    return node_index;
+}
+
+void build_sbvh(const model_t &model, std::vector<triangle_t> &&triangles, const float split_budget, bvh_t &tree)
+{
+    const trace_zone_t zone("build_sbvh");
+
+    box_t bounds, centroid_bounds;
+    triangle_bounds(triangles.data(), triangles.size(), bounds, centroid_bounds);
+
+    sbvh_builder_t builder
+    {
+        .model = model,
+        .tree = tree,
+        .budget = static_cast<std::size_t>(static_cast<float>(triangles.size()) * split_budget),
+        .root_area = box_area(bounds),
+    };
+
+    tree.map.clear();
+    tree.map.reserve(triangles.size() + builder.budget);
+
+    build_sbvh_node(builder, std::move(triangles), 0);
+}
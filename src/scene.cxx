@@ -0,0 +1,94 @@
+#include <array>
+#include <memory_resource>
+#include <glrt/kernel.hxx>
+#include <glrt/scene.hxx>
+#include <glrt/trace.hxx>
+
+static constexpr auto IDENTITY = identity<4, float>();
+
+static void transform_vertices(const mat4f &transform, std::vector<vertex_t> &vertices, const std::size_t begin)
+{
+    if (transform == IDENTITY)
+        return;
+
+    transform_vertices(transform, vertices.data() + begin, vertices.size() - begin);
+}
+
+void scene_builder_t::add(const model_t &model, const mat4f &transform)
+{
+    m_Parts.push_back(
+        {
+            .model = &model,
+            .transform = transform,
+            .owned = nullptr,
+        });
+}
+
+void scene_builder_t::add(model_t &&model, const mat4f &transform)
+{
+    auto &owned = m_Storage.emplace_back(std::move(model));
+
+    m_Parts.push_back(
+        {
+            .model = &owned,
+            .transform = transform,
+            .owned = &owned,
+        });
+}
+
+void scene_builder_t::build(model_t &model)
+{
+    const trace_zone_t zone("scene_builder_t::build");
+
+    auto index_count = model.indices.size();
+    auto vertex_count = model.vertices.size();
+    auto material_count = model.materials.size();
+
+    for (auto &part : m_Parts)
+    {
+        index_count += part.model->indices.size();
+        vertex_count += part.model->vertices.size();
+        material_count += part.model->materials.size();
+    }
+
+    auto part = m_Parts.begin();
+
+    if (part != m_Parts.end() && part->owned && model.vertices.empty() && model.materials.empty())
+    {
+        model = std::move(*part->owned);
+        transform_vertices(part->transform, model.vertices, 0);
+        ++part;
+    }
+
+    model.indices.reserve(index_count);
+    model.vertices.reserve(vertex_count);
+    model.materials.reserve(material_count);
+
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+
+    for (; part != m_Parts.end(); ++part)
+    {
+        arena.release();
+
+        auto &other = *part->model;
+
+        std::pmr::vector<std::uint32_t> remap(&arena);
+        model.merge_materials(other, remap);
+
+        const auto base = static_cast<std::uint32_t>(model.vertices.size());
+        for (auto &index : other.indices)
+            model.indices.push_back(index + base);
+
+        model.vertices.insert(model.vertices.end(), other.vertices.begin(), other.vertices.end());
+
+        for (auto v = model.vertices.begin() + base; v != model.vertices.end(); ++v)
+            if (v->material < remap.size())
+                v->material = remap[v->material];
+
+        transform_vertices(part->transform, model.vertices, base);
+    }
+
+    m_Parts.clear();
+    m_Storage.clear();
+}
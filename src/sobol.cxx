@@ -0,0 +1,41 @@
+#include <glrt/sobol.hxx>
+
+struct sobol_polynomial_t
+{
+    std::uint32_t degree;
+    std::uint32_t coefficients;
+    std::uint32_t m[3];
+};
+
+// primitive polynomials and initial direction numbers for dimensions 1..3 (Joe & Kuo)
+static constexpr sobol_polynomial_t POLYNOMIALS[SOBOL_DIMENSIONS - 1]
+{
+    { 1, 0, { 1 } },
+    { 2, 1, { 1, 3 } },
+    { 3, 1, { 1, 3, 1 } },
+};
+
+void build_sobol_directions(std::vector<std::uint32_t> &directions)
+{
+    directions.assign(SOBOL_DIMENSIONS * SOBOL_BITS, 0);
+
+    for (std::uint32_t k = 0; k < SOBOL_BITS; ++k)
+        directions[k] = 1u << (SOBOL_BITS - 1 - k);
+
+    for (std::uint32_t d = 1; d < SOBOL_DIMENSIONS; ++d)
+    {
+        auto &[s, a, m] = POLYNOMIALS[d - 1];
+        const auto v = directions.data() + d * SOBOL_BITS;
+
+        for (std::uint32_t k = 0; k < s; ++k)
+            v[k] = m[k] << (SOBOL_BITS - 1 - k);
+
+        for (auto k = s; k < SOBOL_BITS; ++k)
+        {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for (std::uint32_t j = 1; j < s; ++j)
+                if ((a >> (s - 1 - j)) & 1u)
+                    v[k] ^= v[k - j];
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <glrt/gl.hxx>
+#include <glrt/trace.hxx>
+
+struct trace_event_t
+{
+    const char *name;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+// never freed: the owning thread keeps a pointer for as long as it lives
+struct trace_buffer_t
+{
+    std::uint32_t id{};
+    std::string name;
+    std::vector<trace_event_t> events;
+    trace_buffer_t *next{};
+};
+
+struct gpu_event_t
+{
+    const char *name;
+    gl::Query begin;
+    gl::Query end;
+};
+
+static std::atomic<bool> s_Enabled;
+static std::atomic<trace_buffer_t *> s_Buffers;
+static std::atomic<std::uint32_t> s_BufferCount;
+
+static std::filesystem::path s_Path;
+static std::chrono::steady_clock::time_point s_Origin;
+
+// touched only from the gl context thread
+static std::vector<gpu_event_t> s_GpuEvents;
+static std::int64_t s_GpuOffset;
+static bool s_GpuCalibrated;
+
+static thread_local trace_buffer_t *t_Buffer;
+static thread_local std::string t_Name;
+
+static std::uint64_t trace_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Origin).count();
+}
+
+static trace_buffer_t &thread_buffer()
+{
+    if (t_Buffer)
+        return *t_Buffer;
+
+    const auto buffer = new trace_buffer_t{ .id = s_BufferCount.fetch_add(1, std::memory_order_relaxed) };
+    buffer->name = t_Name.empty() ? "thread " + std::to_string(buffer->id) : t_Name;
+    buffer->events.reserve(256);
+
+    buffer->next = s_Buffers.load(std::memory_order_relaxed);
+    while (!s_Buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    return *(t_Buffer = buffer);
+}
+
+void trace_begin(const std::filesystem::path &path)
+{
+    s_Path = path;
+    s_Origin = std::chrono::steady_clock::now();
+
+    trace_thread_name("main");
+    s_Enabled.store(true, std::memory_order_release);
+}
+
+bool trace_enabled()
+{
+    return s_Enabled.load(std::memory_order_relaxed);
+}
+
+void trace_thread_name(std::string name)
+{
+    t_Name = std::move(name);
+}
+
+static void write_event(
+    std::ostream &stream,
+    bool &first,
+    const char *name,
+    const char *category,
+    const std::uint32_t tid,
+    const std::uint64_t begin,
+    const std::uint64_t end)
+{
+    stream << (first ? "\n" : ",\n")
+           << R"({"name":")" << name << R"(","cat":")" << category << R"(","ph":"X","pid":1,"tid":)" << tid
+           << R"(,"ts":)" << static_cast<double>(begin) * 1e-3
+           << R"(,"dur":)" << static_cast<double>(end - begin) * 1e-3 << '}';
+    first = false;
+}
+
+static void write_thread_name(std::ostream &stream, bool &first, const std::uint32_t tid, const std::string &name)
+{
+    stream << (first ? "\n" : ",\n")
+           << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+           << R"(,"args":{"name":")" << name << R"("}})";
+    first = false;
+}
+
+bool trace_end()
+{
+    if (!s_Enabled.exchange(false, std::memory_order_acquire))
+        return true;
+
+    std::ofstream stream(s_Path);
+    if (!stream)
+        return false;
+
+    stream << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    stream.precision(15);
+
+    auto first = true;
+
+    // zones still open on other threads are simply not in the file; the caller ends tracing between jobs
+    for (auto buffer = s_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        write_thread_name(stream, first, buffer->id, buffer->name);
+        for (auto &event : buffer->events)
+            write_event(stream, first, event.name, "cpu", buffer->id, event.begin, event.end);
+    }
+
+    // a row after every cpu thread; waiting on the last query drains whatever the gpu still has queued
+    const auto gpu_tid = s_BufferCount.load(std::memory_order_relaxed);
+    if (!s_GpuEvents.empty())
+        write_thread_name(stream, first, gpu_tid, "gpu");
+
+    for (auto &event : s_GpuEvents)
+    {
+        const auto begin = static_cast<std::int64_t>(event.begin.Result()) + s_GpuOffset;
+        const auto end = static_cast<std::int64_t>(event.end.Result()) + s_GpuOffset;
+        write_event(stream, first, event.name, "gpu", gpu_tid, begin, end);
+    }
+
+    stream << "\n]}\n";
+
+    s_GpuEvents.clear();
+    return static_cast<bool>(stream);
+}
+
+trace_zone_t::trace_zone_t(const char *name)
+{
+    if (!trace_enabled())
+        return;
+
+    m_Name = name;
+    m_Begin = trace_now();
+}
+
+trace_zone_t::~trace_zone_t()
+{
+    if (!m_Name)
+        return;
+
+    thread_buffer().events.push_back({ m_Name, m_Begin, trace_now() });
+}
+
+gpu_zone_t::gpu_zone_t(const char *name)
+{
+    if (!trace_enabled())
+        return;
+
+    // gpu timestamps have their own origin; one paired reading maps them onto the cpu clock
+    if (!s_GpuCalibrated)
+    {
+        GLint64 gpu_time;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_time);
+        s_GpuOffset = static_cast<std::int64_t>(trace_now()) - gpu_time;
+        s_GpuCalibrated = true;
+    }
+
+    m_Index = s_GpuEvents.size();
+    s_GpuEvents.push_back({ name, gl::Query(GL_TIMESTAMP), gl::Query(GL_TIMESTAMP) });
+    s_GpuEvents[m_Index].begin.Counter();
+}
+
+gpu_zone_t::~gpu_zone_t()
+{
+    // a trace that ended inside the scope has already dropped the queries
+    if (m_Index >= s_GpuEvents.size())
+        return;
+
+    s_GpuEvents[m_Index].end.Counter();
+}
@@ -0,0 +1,26 @@
+#include <glrt/bvh.hxx>
+#include <glrt/variant.hxx>
+
+variant_t select_variant(const model_t &model)
+{
+    variant_t variant
+    {
+        .max_bounces = DEFAULT_MAX_BOUNCES,
+        .leaf_size = MAX_LEAF_TRIS,
+    };
+
+    for (auto &material : model.materials)
+    {
+        if (material.is_emissive())
+            continue;
+
+        if (material.metallic < 1.0f)
+            variant.lobes |= LOBE_DIFFUSE;
+        if (material.sheen > 0.0f)
+            variant.lobes |= LOBE_SHEEN;
+        if (material.clearcoat_thickness > 0.0f)
+            variant.lobes |= LOBE_CLEARCOAT;
+    }
+
+    return variant;
+}
@@ -10,6 +10,11 @@ static void error_callback(const int error, const char *description)
 }
 
 Window::Window()
+    : Window(600, 600)
+{
+}
+
+Window::Window(const int width, const int height)
 {
     glfwSetErrorCallback(error_callback);
     glfwInit();
@@ -22,8 +27,8 @@ Window::Window()
     glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
 
     m_Handle = glfwCreateWindow(
-        600,
-        600,
+        width,
+        height,
         "GLRT",
         nullptr,
         nullptr);
@@ -71,6 +76,21 @@ void Window::SetFramebufferSizeCallback(void (*callback)(GLFWwindow *window, int
     glfwSetFramebufferSizeCallback(m_Handle, callback);
 }
 
+bool Window::GetKey(const int key) const
+{
+    return glfwGetKey(m_Handle, key) == GLFW_PRESS;
+}
+
+bool Window::GetMouseButton(const int button) const
+{
+    return glfwGetMouseButton(m_Handle, button) == GLFW_PRESS;
+}
+
+void Window::GetCursorPos(double &x, double &y) const
+{
+    glfwGetCursorPos(m_Handle, &x, &y);
+}
+
 void Window::Show() const
 {
     glfwShowWindow(m_Handle);
@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <glrt/bvh.hxx>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+#include <glrt/obj.hxx>
+
+// builds the binned and the spatial-split tree of each scene, compacts them and checks on the cpu that every
+// dequantized child box encloses the full-precision box it was quantized from; exits non-zero on the first miss
+
+static constexpr float SPLIT_BUDGET = 0.3f;
+
+static bool is_leaf(const bvh_node_t &node)
+{
+    return node.begin != node.end || node.left == 0xffffffffu;
+}
+
+static bool encloses(const box_t &outer, const vec3f &min, const vec3f &max)
+{
+    for (unsigned axis = 0; axis < 3; ++axis)
+        if (!(outer.min[axis] <= min[axis] && outer.max[axis] >= max[axis]))
+            return false;
+    return true;
+}
+
+// walks the full tree in the order compact_bvh emits inner nodes: a node, then its left and its right subtree
+static bool check_node(const bvh_t &tree, const std::uint32_t index, std::size_t &slot, std::uint64_t &checked)
+{
+    if (slot >= tree.compact_nodes.size())
+    {
+        std::cerr << "compact tree ends before node " << index << std::endl;
+        return false;
+    }
+
+    const auto &node = tree.nodes[index];
+    const auto &compact = tree.compact_nodes[slot++];
+
+    for (const unsigned child : { 0u, 1u })
+    {
+        const auto &full = tree.nodes[child ? node.right : node.left];
+        const auto box = dequantize_child(compact, child);
+
+        if (!encloses(box, full.box_min, full.box_max))
+        {
+            std::cerr << "node " << index << " child " << child << ": dequantized box does not enclose the child"
+                    << std::endl;
+            return false;
+        }
+        checked++;
+    }
+
+    for (const auto child : { node.left, node.right })
+        if (!is_leaf(tree.nodes[child]) && !check_node(tree, child, slot, checked))
+            return false;
+
+    return true;
+}
+
+static bool check_tree(const std::string &name, const model_t &model, const bvh_options_t &options)
+{
+    bvh_t tree;
+    build_bvh(model, tree, options);
+
+    if (!compact_bvh(tree))
+    {
+        std::cerr << name << ": compact build failed" << std::endl;
+        return false;
+    }
+
+    std::size_t slot = 0;
+    std::uint64_t checked = 0;
+
+    if (!tree.nodes.empty() && !is_leaf(tree.nodes[0]))
+    {
+        if (!check_node(tree, 0, slot, checked))
+            return false;
+
+        if (slot != tree.compact_nodes.size())
+        {
+            std::cerr << name << ": " << tree.compact_nodes.size() - slot << " compact nodes left over" << std::endl;
+            return false;
+        }
+    }
+
+    std::cerr << name << ": " << checked << " child boxes enclosed" << std::endl;
+    return true;
+}
+
+// one triangle far out on every axis, so the coarsest scales are exercised, and a cluster near the origin
+static model_t make_wide_scene()
+{
+    model_t model;
+    model.material_map.emplace("wide", 0);
+    model.materials.push_back({ .albedo = { 0.8f, 0.8f, 0.8f }, .roughness = 0.5f });
+
+    const float far = 1e37f;
+    for (const vec3f corner : { vec3f{ -far, -far, -far }, vec3f{ far, far, far }, vec3f{ 0.0f, 0.0f, 0.0f } })
+        for (std::uint32_t i = 0; i < 16; ++i)
+        {
+            const auto offset = static_cast<float>(i) * 1e-3f;
+            const auto base = static_cast<std::uint32_t>(model.vertices.size());
+            for (const vec3f p : { vec3f{ offset, 0.0f, 0.0f }, vec3f{ 0.0f, offset, 1.0f }, vec3f{ 1.0f, 0.0f, offset } })
+                model.vertices.push_back({ .position = corner + p, .normal = { 0.0f, 0.0f, 1.0f } });
+            model.indices.insert(model.indices.end(), { base, base + 1, base + 2 });
+        }
+
+    return model;
+}
+
+// a child with nan bounds cannot be enclosed at any scale; the build has to say so
+static bool check_unquantizable()
+{
+    constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+
+    bvh_t tree;
+    tree.nodes = {
+        { .box_min = { 0.0f, 0.0f, 0.0f }, .box_max = { nan, 1.0f, 1.0f }, .left = 1, .right = 2 },
+        { .box_min = { 0.0f, 0.0f, 0.0f }, .box_max = { 1.0f, 1.0f, 1.0f }, .begin = 0, .end = 1 },
+        { .box_min = { 0.0f, 0.0f, 0.0f }, .box_max = { nan, 1.0f, 1.0f }, .begin = 1, .end = 2 },
+    };
+
+    if (compact_bvh(tree) || !tree.compact_nodes.empty())
+    {
+        std::cerr << "nan bounds: compact build succeeded" << std::endl;
+        return false;
+    }
+
+    std::cerr << "nan bounds: compact build refused" << std::endl;
+    return true;
+}
+
+int main()
+{
+    std::vector<std::pair<std::string, model_t>> scenes;
+
+    for (const auto name : { "cornell", "teapot" })
+    {
+        model_t model;
+        read_obj("asset/model/" + std::string(name) + "/" + name + ".obj", model);
+        if (model.indices.empty())
+        {
+            std::cerr << "failed to load " << name << std::endl;
+            return 1;
+        }
+        scenes.emplace_back(name, std::move(model));
+    }
+    scenes.emplace_back("wide", make_wide_scene());
+
+    for (const auto &[name, model] : scenes)
+        if (!check_tree(name + " binned", model, {}) || !check_tree(name + " sbvh", model, { .split_budget = SPLIT_BUDGET }))
+            return 1;
+
+    return check_unquantizable() ? 0 : 1;
+}
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <glrt/bvh.hxx>
+#include <glrt/edit.hxx>
+#include <glrt/obj.hxx>
+#include <glrt/scene.hxx>
+#include <glrt/triangle.hxx>
+
+// applies random inserts, removes and replaces to an editable scene and checks after every few edits that the tree
+// links, boxes, triangle set and light list agree with the objects alive, and that rays find the same closest hit as
+// brute force; exits non-zero on the first broken invariant, then reports how long the edits take
+
+static constexpr std::uint32_t EDIT_COUNT = 400;
+static constexpr std::uint32_t CHECK_INTERVAL = 10;
+static constexpr std::uint32_t CHECK_RAYS = 64;
+
+// boxes are unions of float positions, so they enclose exactly; the slack only absorbs transformed copies
+static constexpr float BOX_SLACK = 1e-4f;
+
+static constexpr float NO_HIT = std::numeric_limits<float>::infinity();
+
+static bool encloses(const vec3f &min, const vec3f &max, const vec3f &p)
+{
+    for (unsigned axis = 0; axis < 3; ++axis)
+        if (p[axis] < min[axis] - BOX_SLACK || p[axis] > max[axis] + BOX_SLACK)
+            return false;
+    return true;
+}
+
+static float hit_triangle(const vec3f &origin, const vec3f &direction, const model_t &model, const std::uint32_t first)
+{
+    const auto &p0 = model.vertices[model.indices[first]].position;
+    const auto &p1 = model.vertices[model.indices[first + 1]].position;
+    const auto &p2 = model.vertices[model.indices[first + 2]].position;
+
+    const auto e1 = p1 - p0;
+    const auto e2 = p2 - p0;
+    const auto h = cross(direction, e2);
+    const auto a = dot(e1, h);
+    if (std::fabs(a) < 1e-12f)
+        return NO_HIT;
+
+    const auto f = 1.0f / a;
+    const auto s = origin - p0;
+    const auto u = f * dot(s, h);
+    if (u < 0.0f || u > 1.0f)
+        return NO_HIT;
+
+    const auto q = cross(s, e1);
+    const auto v = f * dot(direction, q);
+    if (v < 0.0f || u + v > 1.0f)
+        return NO_HIT;
+
+    const auto t = f * dot(e2, q);
+    return t > 1e-5f ? t : NO_HIT;
+}
+
+static bool hit_box(const vec3f &origin, const vec3f &direction, const bvh_node_t &node, const float t_max)
+{
+    auto t0 = 0.0f;
+    auto t1 = t_max;
+    for (unsigned axis = 0; axis < 3; ++axis)
+    {
+        const auto inv = 1.0f / direction[axis];
+        auto a = (node.box_min[axis] - origin[axis]) * inv;
+        auto b = (node.box_max[axis] - origin[axis]) * inv;
+        if (a > b)
+            std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+    }
+    return t0 <= t1;
+}
+
+static bool fail(const std::string &message)
+{
+    std::cerr << message << std::endl;
+    return false;
+}
+
+// first index of every triangle owned by a live object
+static std::multiset<std::uint32_t> live_triangles(const editable_scene_t &scene)
+{
+    std::multiset<std::uint32_t> triangles;
+    for (const auto &object : scene.objects)
+        if (object.alive)
+            for (auto first = object.indices.begin; first < object.indices.begin + object.indices.count; first += 3)
+                triangles.insert(first);
+    return triangles;
+}
+
+static bool check_tree(const editable_scene_t &scene, const std::multiset<std::uint32_t> &expected)
+{
+    const auto &nodes = scene.bvh.nodes;
+    const auto &model = scene.model;
+
+    std::multiset<std::uint32_t> reached;
+
+    if (!scene.empty)
+    {
+        if (scene.parents[0] != EDIT_NONE)
+            return fail("root has a parent");
+
+        std::vector<std::uint32_t> stack{ 0 };
+        while (!stack.empty())
+        {
+            const auto index = stack.back();
+            stack.pop_back();
+            const auto &node = nodes[index];
+
+            if (node.begin != node.end)
+            {
+                for (auto i = node.begin; i < node.end; ++i)
+                {
+                    const auto first = scene.bvh.map[i];
+                    reached.insert(first);
+
+                    for (unsigned corner = 0; corner < 3; ++corner)
+                        if (!encloses(node.box_min, node.box_max, model.vertices[model.indices[first + corner]].position))
+                            return fail("leaf " + std::to_string(index) + " does not enclose its triangles");
+                }
+                continue;
+            }
+
+            for (const auto child : { node.left, node.right })
+            {
+                if (scene.parents[child] != index)
+                    return fail("node " + std::to_string(child) + " does not link back to " + std::to_string(index));
+
+                if (!encloses(node.box_min, node.box_max, nodes[child].box_min)
+                    || !encloses(node.box_min, node.box_max, nodes[child].box_max))
+                    return fail("node " + std::to_string(index) + " does not enclose " + std::to_string(child));
+
+                stack.push_back(child);
+            }
+        }
+    }
+
+    if (reached != expected)
+        return fail("the tree does not reach exactly the live triangles");
+
+    return true;
+}
+
+static bool check_lights(const editable_scene_t &scene, const std::multiset<std::uint32_t> &expected)
+{
+    const auto &model = scene.model;
+
+    double sum = 0.0;
+    std::set<std::uint32_t> lights;
+    for (std::size_t i = 0; i < scene.bvh.lights.size(); ++i)
+        if (scene.bvh.light_areas[i] > 0.0f)
+        {
+            sum += scene.bvh.light_areas[i];
+            lights.insert(scene.bvh.lights[i]);
+        }
+
+    std::set<std::uint32_t> emissive;
+    for (const auto first : expected)
+    {
+        const auto &v0 = model.vertices[model.indices[first]];
+        const auto area = triangle_area(
+            v0.position,
+            model.vertices[model.indices[first + 1]].position,
+            model.vertices[model.indices[first + 2]].position);
+
+        if (model.materials[v0.material].is_emissive() && area > 0.0f)
+            emissive.insert(first);
+    }
+
+    if (lights != emissive)
+        return fail("the light list does not match the live emissive triangles");
+
+    if (std::fabs(sum - scene.bvh.total_light_area) > 1e-3 * std::max(1.0, sum))
+        return fail("total light area drifted from the sum of the light areas");
+
+    return true;
+}
+
+static bool check_rays(const editable_scene_t &scene, const std::multiset<std::uint32_t> &expected, std::mt19937 &rng)
+{
+    if (scene.empty)
+        return true;
+
+    const auto &nodes = scene.bvh.nodes;
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+    for (std::uint32_t ray = 0; ray < CHECK_RAYS; ++ray)
+    {
+        const vec3f origin{ uniform(rng) * 6.0f, uniform(rng) * 6.0f, uniform(rng) * 6.0f };
+        const auto direction = normalize(vec3f{ uniform(rng), uniform(rng), uniform(rng) });
+
+        auto brute = NO_HIT;
+        for (const auto first : expected)
+            brute = std::min(brute, hit_triangle(origin, direction, scene.model, first));
+
+        auto traced = NO_HIT;
+        std::vector<std::uint32_t> stack{ 0 };
+        while (!stack.empty())
+        {
+            const auto &node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (!hit_box(origin, direction, node, traced))
+                continue;
+
+            if (node.begin != node.end)
+                for (auto i = node.begin; i < node.end; ++i)
+                    traced = std::min(traced, hit_triangle(origin, direction, scene.model, scene.bvh.map[i]));
+            else
+                stack.insert(stack.end(), { node.left, node.right });
+        }
+
+        if (traced != brute)
+            return fail("traversal and brute force disagree on a closest hit");
+    }
+
+    return true;
+}
+
+static bool check_scene(const editable_scene_t &scene, std::mt19937 &rng)
+{
+    const auto expected = live_triangles(scene);
+    return check_tree(scene, expected) && check_lights(scene, expected) && check_rays(scene, expected, rng);
+}
+
+static double elapsed_us(const std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main()
+{
+    model_t cornell, teapot, cube;
+    read_obj("asset/model/cornell/cornell.obj", cornell);
+    read_obj("asset/model/teapot/teapot.obj", teapot);
+    read_obj("asset/model/cube/cube.obj", cube);
+    if (cornell.indices.empty() || teapot.indices.empty() || cube.indices.empty())
+    {
+        std::cerr << "failed to load the models under asset/model" << std::endl;
+        return 1;
+    }
+
+    cube.material_map.emplace("prop", 0);
+    cube.materials.push_back({ .albedo = { 0.8f, 0.8f, 0.8f } });
+
+    auto lamp = cube;
+    lamp.material_map = { { "lamp", 0 } };
+    lamp.materials[0].emission = { 5.0f, 5.0f, 5.0f };
+
+    model_t data;
+    {
+        scene_builder_t builder;
+        builder.add(cornell, scale(4.0f, 4.0f, 4.0f));
+        builder.add(teapot, translation(0.0f, -4.0f, 0.0f));
+        builder.build(data);
+    }
+
+    bvh_t bvh;
+    build_bvh(data, bvh);
+
+    editable_scene_t scene;
+    make_editable(std::move(data), std::move(bvh), scene);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-4.0f, 4.0f);
+
+    if (!check_scene(scene, rng))
+        return 1;
+
+    std::vector<std::uint32_t> live;
+    std::vector<double> insert_us, remove_us, replace_us;
+
+    for (std::uint32_t edit = 0; edit < EDIT_COUNT; ++edit)
+    {
+        const auto op = rng() % 6;
+        const auto begin = std::chrono::steady_clock::now();
+
+        if (op < 3 || live.empty())
+        {
+            const auto &mesh = op == 0 ? lamp : op == 1 ? teapot : cube;
+            const auto transform = translation(position(rng), position(rng), position(rng)) * scale(0.3f, 0.3f, 0.3f);
+            live.push_back(insert_mesh(scene, mesh, transform));
+            insert_us.push_back(elapsed_us(begin));
+        }
+        else if (op < 5)
+        {
+            const auto i = rng() % live.size();
+            remove_mesh(scene, live[i]);
+            live.erase(live.begin() + i);
+            remove_us.push_back(elapsed_us(begin));
+        }
+        else
+        {
+            const auto &mesh = rng() % 2 ? lamp : cube;
+            replace_mesh(scene, live[rng() % live.size()], mesh, translation(position(rng), position(rng), position(rng)));
+            replace_us.push_back(elapsed_us(begin));
+        }
+
+        // the object the scene was built from, and a light material switched off and on again
+        if (edit == EDIT_COUNT / 4)
+            remove_mesh(scene, 0);
+
+        if (edit == EDIT_COUNT / 2 || edit == EDIT_COUNT * 5 / 8)
+        {
+            const auto index = scene.model.material_map.at("lamp");
+            auto material = scene.model.materials[index];
+            material.emission = edit == EDIT_COUNT / 2 ? vec3f{} : vec3f{ 3.0f, 3.0f, 3.0f };
+            replace_material(scene, index, material);
+        }
+
+        if (edit % CHECK_INTERVAL == 0 && !check_scene(scene, rng))
+        {
+            std::cerr << "after edit " << edit << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto object : live)
+        remove_mesh(scene, object);
+
+    if (!check_scene(scene, rng) || !scene.empty)
+    {
+        std::cerr << "removing every object did not leave an empty scene" << std::endl;
+        return 1;
+    }
+
+    // an emptied scene has to take objects again
+    insert_mesh(scene, cube, translation(1.0f, 1.0f, 1.0f));
+    if (!check_scene(scene, rng))
+        return 1;
+
+    std::cerr << EDIT_COUNT << " edits checked" << std::endl;
+
+    for (auto [name, times] : { std::pair{ "insert", &insert_us }, { "remove", &remove_us }, { "replace", &replace_us } })
+    {
+        if (times->empty())
+            continue;
+
+        std::sort(times->begin(), times->end());
+        std::cerr << std::left << std::setw(8) << name << std::right
+                << std::setw(5) << times->size() << " edits, median "
+                << std::fixed << std::setprecision(1) << std::setw(8) << (*times)[times->size() / 2] << " us, max "
+                << std::setw(8) << times->back() << " us" << std::endl;
+    }
+}
@@ -0,0 +1,147 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+#include <glrt/scene.hxx>
+
+// assembles the same synthetic scene by repeated operator+= and through scene_builder_t, counting heap allocations
+// and time for each; fails if the builder's allocations grow with the number of parts
+
+static constexpr std::uint32_t PART_COUNT = 256;
+static constexpr std::uint32_t PART_GRID = 32;
+
+// materials outside the shared set are unique per part, so each adds one name to material_map
+static constexpr std::uint32_t SHARED_MATERIALS = 4;
+
+// the destination's three arrays and the builder's part list, which doubles about log2(PART_COUNT) times
+static constexpr std::uint64_t FIXED_ALLOCATIONS = 24;
+
+static std::atomic<std::uint64_t> s_Allocations;
+
+void *operator new(const std::size_t size)
+{
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// a flat grid with one shared and one unique material
+static model_t make_part(const std::uint32_t index)
+{
+    model_t part;
+
+    for (std::uint32_t y = 0; y <= PART_GRID; ++y)
+        for (std::uint32_t x = 0; x <= PART_GRID; ++x)
+        {
+            part.vertices.push_back(
+                {
+                    .position = { static_cast<float>(x), static_cast<float>(y), 0.0f },
+                    .normal = { 0.0f, 0.0f, 1.0f },
+                    .material = (x + y) % 2,
+                });
+        }
+
+    for (std::uint32_t y = 0; y < PART_GRID; ++y)
+        for (std::uint32_t x = 0; x < PART_GRID; ++x)
+        {
+            const auto i = y * (PART_GRID + 1) + x;
+            part.indices.insert(part.indices.end(), { i, i + 1, i + PART_GRID + 1, i + 1, i + PART_GRID + 2, i + PART_GRID + 1 });
+        }
+
+    part.material_map.emplace("shared" + std::to_string(index % SHARED_MATERIALS), 0);
+    part.material_map.emplace("unique" + std::to_string(index), 1);
+    part.materials.push_back({ .albedo = { 0.8f, 0.8f, 0.8f }, .roughness = 0.5f });
+    part.materials.push_back({ .albedo = { 0.2f, 0.4f, static_cast<float>(index) / PART_COUNT }, .roughness = 0.3f });
+
+    return part;
+}
+
+struct measurement_t
+{
+    std::uint64_t allocations{};
+    double milliseconds{};
+    std::size_t triangles{};
+};
+
+template<typename F>
+static measurement_t measure(F &&assemble)
+{
+    model_t scene;
+
+    const auto allocations = s_Allocations.load(std::memory_order_relaxed);
+    const auto begin = std::chrono::steady_clock::now();
+
+    assemble(scene);
+
+    const auto end = std::chrono::steady_clock::now();
+    return {
+        .allocations = s_Allocations.load(std::memory_order_relaxed) - allocations,
+        .milliseconds = std::chrono::duration<double, std::milli>(end - begin).count(),
+        .triangles = scene.indices.size() / 3,
+    };
+}
+
+static void report(const char *name, const measurement_t &measurement)
+{
+    std::cerr << std::left << std::setw(22) << name << std::right
+            << std::setw(8) << measurement.allocations << " allocations "
+            << std::fixed << std::setprecision(3) << std::setw(10) << measurement.milliseconds << " ms, "
+            << measurement.triangles << " triangles" << std::endl;
+}
+
+int main()
+{
+    std::vector<model_t> parts;
+    std::vector<mat4f> transforms;
+    for (std::uint32_t i = 0; i < PART_COUNT; ++i)
+    {
+        parts.push_back(make_part(i));
+        transforms.push_back(translation(static_cast<float>(i % 16) * 40.0f, static_cast<float>(i / 16) * 40.0f, 0.0f));
+    }
+
+    const auto appended = measure(
+        [&](model_t &scene)
+        {
+            for (std::uint32_t i = 0; i < PART_COUNT; ++i)
+                scene += transforms[i] * parts[i];
+        });
+
+    // the builder is constructed inside, so its own storage counts too
+    const auto built = measure(
+        [&](model_t &scene)
+        {
+            scene_builder_t builder;
+            for (std::uint32_t i = 0; i < PART_COUNT; ++i)
+                builder.add(parts[i], transforms[i]);
+            builder.build(scene);
+        });
+
+    report("operator+=", appended);
+    report("scene_builder_t", built);
+
+    // every material name is one map node; anything beyond that and the fixed arrays is per-part churn
+    const auto limit = FIXED_ALLOCATIONS + SHARED_MATERIALS + PART_COUNT;
+    if (built.allocations > limit || built.triangles != appended.triangles)
+    {
+        std::cerr << "scene_builder_t made " << built.allocations << " allocations, expected at most " << limit
+                << std::endl;
+        return 1;
+    }
+}
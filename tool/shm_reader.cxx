@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <glrt/frame_ring.hxx>
+#include <glrt/image.hxx>
+
+// follows the frame ring glrt publishes with --export, reports frame rate, skipped frames and publish-to-read
+// latency, and can write the last frame it read
+
+struct reader_options_t
+{
+    std::string name;
+    std::uint32_t frames = 0;
+    std::filesystem::path output;
+};
+
+struct reader_stats_t
+{
+    std::uint64_t frames{};
+    std::uint64_t skipped{};
+    std::uint64_t torn{};
+    double latency_sum{};
+    double latency_max{};
+    double copy_seconds{};
+};
+
+static void print_usage(const std::string_view program)
+{
+    std::cerr
+            << "usage: " << program << " <name> [options]\n"
+            << "  --frames <n>              stop after n frames (default 0, until glrt closes the ring)\n"
+            << "  --output <path>           write the last frame, .ppm for ldr rings and .pfm for raw ones\n";
+}
+
+static bool parse_uint(const std::string_view str, std::uint32_t &value)
+{
+    const auto end = str.data() + str.size();
+    const auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+static bool parse_options(const int argc, const char *const *argv, reader_options_t &options)
+{
+    const std::string_view program = argc ? argv[0] : "glrt_shm_reader";
+
+    if (argc < 2 || std::string_view(argv[1]) == "--help")
+    {
+        print_usage(program);
+        return false;
+    }
+
+    options.name = "/" + std::string(argv[1]);
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            print_usage(program);
+            return false;
+        }
+
+        const std::string_view value = argv[++i];
+
+        auto ok = true;
+        if (arg == "--frames")
+            ok = parse_uint(value, options.frames);
+        else if (arg == "--output")
+            options.output = value;
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            print_usage(program);
+            return false;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "invalid value '" << value << "' for " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static double now_ns()
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static bool write_ppm(const std::filesystem::path &path, const frame_info_t &info, const std::vector<std::byte> &pixels)
+{
+    std::ofstream stream(path, std::ofstream::binary | std::ofstream::trunc);
+    if (!stream)
+        return false;
+
+    stream << "P6\n" << info.width << ' ' << info.height << "\n255\n";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(info.width) * info.height; ++i)
+        stream.write(reinterpret_cast<const char *>(pixels.data() + i * 4), 3);
+    return static_cast<bool>(stream);
+}
+
+// pfm rows run bottom to top, and the raw ring keeps sums; the file gets the estimate
+static bool write_raw(const std::filesystem::path &path, const frame_info_t &info, const std::vector<std::byte> &pixels)
+{
+    const auto rgba = reinterpret_cast<const float *>(pixels.data());
+
+    image_t image{ .width = info.width, .height = info.height };
+    image.pixels.resize(static_cast<std::size_t>(info.width) * info.height * 3);
+
+    for (std::size_t y = 0; y < info.height; ++y)
+        for (std::size_t x = 0; x < info.width; ++x)
+        {
+            const auto source = rgba + ((info.height - 1 - y) * info.width + x) * 4;
+            for (std::size_t c = 0; c < 3; ++c)
+                image.pixels[(y * info.width + x) * 3 + c] = source[c] / std::max(source[3], 1.0f);
+        }
+
+    return write_pfm(path, image);
+}
+
+int main(const int argc, const char *const *argv)
+{
+    reader_options_t options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    frame_ring_t ring;
+    frame_info_t info;
+    std::vector<std::byte> pixels;
+    reader_stats_t stats;
+    auto format = FRAME_RGBA8;
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    while (!options.frames || stats.frames < options.frames)
+    {
+        // glrt may not be up yet, or has moved to a larger segment
+        if (!ring.memory)
+        {
+            if (!open_frame_ring(options.name, ring))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            format = ring_header(ring).format;
+            std::cerr << "reading " << options.name << ", " << (format == FRAME_RGBA32F ? "raw" : "ldr") << std::endl;
+        }
+
+        const auto state = ring_header(ring).state.load(std::memory_order_acquire);
+        const auto previous = info.frame;
+
+        const auto copy_begin = std::chrono::steady_clock::now();
+        if (read_frame(ring, info, pixels))
+        {
+            const auto latency = (now_ns() - static_cast<double>(info.time_ns)) * 1e-6;
+
+            stats.copy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - copy_begin).count();
+            stats.skipped += previous ? info.frame - previous - 1 : 0;
+            stats.latency_sum += latency;
+            stats.latency_max = std::max(stats.latency_max, latency);
+            ++stats.frames;
+
+            std::cerr << std::fixed << std::setprecision(3)
+                    << "frame " << info.frame << ", " << info.width << "x" << info.height << ", "
+                    << info.samples << " spp, " << latency << " ms after publish" << std::endl;
+            continue;
+        }
+
+        if (ring_header(ring).frames.load(std::memory_order_acquire) > info.frame)
+        {
+            ++stats.torn;
+            continue;
+        }
+
+        // nothing newer will come through this mapping
+        if (state != FRAME_RING_OPEN)
+        {
+            close_frame_ring(ring);
+            if (state == FRAME_RING_CLOSED)
+                break;
+
+            // frame numbers restart in the new segment
+            info.frame = 0;
+            continue;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    const auto frames = static_cast<double>(std::max<std::uint64_t>(stats.frames, 1));
+
+    std::cerr << std::fixed << std::setprecision(3)
+            << stats.frames << " frames in " << seconds << " s, " << stats.skipped << " skipped, " << stats.torn
+            << " torn reads retried, latency " << stats.latency_sum / frames << " ms mean " << stats.latency_max
+            << " ms max, copy " << stats.copy_seconds / frames * 1e3 << " ms per frame" << std::endl;
+
+    if (!options.output.empty() && stats.frames)
+    {
+        if (!(format == FRAME_RGBA32F ? write_raw(options.output, info, pixels) : write_ppm(options.output, info, pixels)))
+        {
+            std::cerr << "failed to write " << options.output << std::endl;
+            return 1;
+        }
+    }
+
+    close_frame_ring(ring);
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glrt/bvh.hxx>
+#include <glrt/jobs.hxx>
+#include <glrt/kernel.hxx>
+#include <glrt/math.hxx>
+#include <glrt/model.hxx>
+#include <glrt/obj.hxx>
+
+// times the host stages ported to the job system on the bundled models, once per thread count. jobs() fixes its size
+// on first use, so every count runs in a forked child that sends back medians and output hashes; exits non-zero if
+// a stage's output differs between thread counts
+
+static constexpr unsigned THREAD_COUNTS[] = { 1, 2, 4, 8 };
+static constexpr std::uint32_t REPEATS = 9;
+
+static constexpr const char *STAGE_NAMES[]
+{
+    "read_obj teapot",
+    "read_obj cornell",
+    "read_mtl teapot",
+    "read_mtl cornell",
+    "transform teapot",
+    "build_bvh teapot",
+    "build_bvh cornell",
+};
+
+static constexpr std::size_t STAGE_COUNT = std::size(STAGE_NAMES);
+
+struct stage_result_t
+{
+    double milliseconds{};
+    std::uint64_t hash{};
+};
+
+// fnv-1a over raw bytes; every gpu struct spells out its padding, so equal values hash equal
+template<typename T>
+static std::uint64_t hash_bytes(const std::vector<T> &values, std::uint64_t hash = 14695981039346656037ull)
+{
+    const auto bytes = reinterpret_cast<const unsigned char *>(values.data());
+    for (std::size_t i = 0; i < values.size() * sizeof(T); ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+static std::uint64_t hash_model(const model_t &model)
+{
+    return hash_bytes(model.materials, hash_bytes(model.vertices, hash_bytes(model.indices)));
+}
+
+static std::uint64_t hash_bvh(const bvh_t &tree)
+{
+    return hash_bytes(tree.light_areas, hash_bytes(tree.lights, hash_bytes(tree.map, hash_bytes(tree.nodes))));
+}
+
+// median wall time of REPEATS runs; prepare runs untimed before each, and the last run's output is hashed
+template<typename P, typename F, typename H>
+static stage_result_t measure(P &&prepare, F &&stage, H &&hash)
+{
+    std::vector<double> times;
+    for (std::uint32_t run = 0; run < REPEATS; ++run)
+    {
+        prepare();
+
+        const auto begin = std::chrono::steady_clock::now();
+        stage();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return { times[times.size() / 2], hash() };
+}
+
+static void run_stages(stage_result_t (&results)[STAGE_COUNT])
+{
+    std::size_t stage = 0;
+
+    for (const auto name : { "teapot", "cornell" })
+    {
+        const auto obj = "asset/model/" + std::string(name) + "/" + name + ".obj";
+        model_t model;
+        results[stage++] = measure([&] { model = {}; }, [&] { read_obj(obj, model); }, [&] { return hash_model(model); });
+    }
+
+    for (const auto name : { "teapot", "cornell" })
+    {
+        const auto mtl = "asset/model/" + std::string(name) + "/" + name + ".mtl";
+        model_t model;
+        results[stage++] = measure([&] { model = {}; }, [&] { read_mtl(mtl, model); }, [&] { return hash_model(model); });
+    }
+
+    model_t teapot, cornell;
+    read_obj("asset/model/teapot/teapot.obj", teapot);
+    read_obj("asset/model/cornell/cornell.obj", cornell);
+
+    const auto transform = translation(0.5f, -1.0f, 2.0f) * scale(1.5f, 1.5f, 1.5f);
+    std::vector<vertex_t> vertices;
+    results[stage++] = measure(
+        [&] { vertices = teapot.vertices; },
+        [&] { transform_vertices(transform, vertices.data(), vertices.size()); },
+        [&] { return hash_bytes(vertices); });
+
+    for (const auto model : { &teapot, &cornell })
+    {
+        bvh_t tree;
+        results[stage++] = measure([&] { tree = {}; }, [&] { build_bvh(*model, tree); }, [&] { return hash_bvh(tree); });
+    }
+}
+
+static bool run_child(const unsigned thread_count, stage_result_t (&results)[STAGE_COUNT])
+{
+    int pipe_ends[2];
+    if (pipe(pipe_ends) != 0)
+        return false;
+
+    const auto pid = fork();
+    if (pid < 0)
+    {
+        close(pipe_ends[0]);
+        close(pipe_ends[1]);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        close(pipe_ends[0]);
+        jobs(thread_count);
+
+        stage_result_t child_results[STAGE_COUNT];
+        run_stages(child_results);
+
+        const auto written = write(pipe_ends[1], child_results, sizeof(child_results));
+        _exit(written == sizeof(child_results) ? 0 : 1);
+    }
+
+    close(pipe_ends[1]);
+
+    std::size_t received = 0;
+    const auto bytes = reinterpret_cast<char *>(results);
+    while (received < sizeof(results))
+    {
+        const auto count = read(pipe_ends[0], bytes + received, sizeof(results) - received);
+        if (count <= 0)
+            break;
+        received += static_cast<std::size_t>(count);
+    }
+    close(pipe_ends[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return received == sizeof(results) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main()
+{
+    std::vector<std::vector<stage_result_t>> results;
+
+    for (const auto thread_count : THREAD_COUNTS)
+    {
+        stage_result_t child_results[STAGE_COUNT];
+        if (!run_child(thread_count, child_results))
+        {
+            std::cerr << "stage run with " << thread_count << " threads failed" << std::endl;
+            return 1;
+        }
+        results.emplace_back(std::begin(child_results), std::end(child_results));
+    }
+
+    std::cerr << std::left << std::setw(20) << "stage" << std::right;
+    for (const auto thread_count : THREAD_COUNTS)
+        std::cerr << std::setw(10) << (std::to_string(thread_count) + "t ms") << std::setw(8) << "x";
+    std::cerr << std::endl;
+
+    auto mismatch = false;
+    for (std::size_t stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        const auto serial = results[0][stage];
+
+        std::cerr << std::left << std::setw(20) << STAGE_NAMES[stage] << std::right << std::fixed;
+        for (const auto &run : results)
+        {
+            std::cerr << std::setprecision(3) << std::setw(10) << run[stage].milliseconds
+                    << std::setprecision(2) << std::setw(8) << serial.milliseconds / run[stage].milliseconds;
+            if (run[stage].hash != serial.hash)
+                mismatch = true;
+        }
+        std::cerr << std::endl;
+    }
+
+    std::cerr << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    if (mismatch)
+    {
+        std::cerr << "output differs between thread counts" << std::endl;
+        return 1;
+    }
+}